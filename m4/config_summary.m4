@@ -86,6 +86,12 @@ if test "x$HAVE_GSL" = "x1"; then
 else
   echo '  'GSL......................... : no
 fi
+if test "x$HAVE_OPENMP" = "x1"; then
+  echo '  'OpenMP...................... : yes
+  echo '    'OPENMP_CXXFLAGS........... : $OPENMP_CXXFLAGS
+else
+  echo '  'OpenMP...................... : no
+fi
 echo
 echo '-------------------------------------------------------------------------------'
 
@@ -0,0 +1,344 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+
+#ifndef ANTIOCH_ACTIVE_REACTIONS_H
+#define ANTIOCH_ACTIVE_REACTIONS_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/reaction_set.h"
+
+// C++
+#include <algorithm>
+#include <vector>
+
+namespace Antioch
+{
+
+  //! Reactions worth evaluating in a given state
+  /*!\class ActiveReactions
+   *
+   * A species is absent when its concentration is at most
+   * concentration_threshold(). The forward direction of a reaction is
+   * negligible when one of its reactants (with a nonzero partial order) is
+   * absent, the reverse direction when the reaction is irreversible or one
+   * of its products is absent. A reaction is active unless both directions
+   * are negligible. Below temperature_threshold() the chemistry is frozen
+   * and no reaction is active.
+   *
+   * update() only walks the reactions of the absent species, through the
+   * species-to-reaction incidence built at construction, so rebuilding the
+   * list per cell is cheap. The list is meant to be rebuilt once per cell
+   * and time step and reused by all the evaluations of that step, see
+   * KineticsEvaluator::compute_mole_sources() and
+   * KineticsEvaluator::compute_mole_sources_mask_error().
+   *
+   * With the default thresholds, only the reactions whose rate of progress
+   * is exactly zero are masked.
+   */
+  template<typename CoeffType=double>
+  class ActiveReactions
+  {
+  public:
+
+    //! Constructor, builds the incidence from the reaction set, all reactions active.
+    ActiveReactions( const ReactionSet<CoeffType>& reaction_set );
+
+    ~ActiveReactions();
+
+    //! (Re)build the incidence from \p reaction_set, all reactions active.
+    void build( const ReactionSet<CoeffType>& reaction_set );
+
+    //! Concentrations at or below \p threshold count as absent, defaults to 0.
+    void set_concentration_threshold( const CoeffType threshold );
+
+    //! No reaction is active below \p threshold, defaults to 0.
+    void set_temperature_threshold( const CoeffType threshold );
+
+    CoeffType concentration_threshold() const;
+
+    CoeffType temperature_threshold() const;
+
+    //! Rebuild the lists of active and inactive reactions for this state
+    /*! Scalar states only: the list is specific to one cell. */
+    template <typename StateType, typename VectorStateType>
+    void update( const StateType& T, const VectorStateType& molar_densities );
+
+    //! Mark all the reactions as active.
+    void activate_all();
+
+    unsigned int n_reactions() const;
+
+    unsigned int n_active() const;
+
+    bool is_active( const unsigned int rxn ) const;
+
+    //! Active reactions, in increasing order
+    const std::vector<unsigned int>& active_reactions() const;
+
+    //! Inactive reactions, in increasing order
+    const std::vector<unsigned int>& inactive_reactions() const;
+
+  protected:
+
+    unsigned int _n_species;
+
+    CoeffType _concentration_threshold;
+
+    CoeffType _temperature_threshold;
+
+    //! CSR: reactions in which species s is a reactant are in
+    //  _reactant_reactions[_reactant_offsets[s].._reactant_offsets[s+1]),
+    //  same for the products of the reversible reactions
+    std::vector<unsigned int> _reactant_offsets;
+    std::vector<unsigned int> _reactant_reactions;
+    std::vector<unsigned int> _product_offsets;
+    std::vector<unsigned int> _product_reactions;
+
+    std::vector<bool> _reversible;
+
+    //! per reaction: number of absent reactants and products, scratch of update()
+    std::vector<unsigned int> _absent_reactants;
+    std::vector<unsigned int> _absent_products;
+
+    std::vector<bool> _active;
+    std::vector<unsigned int> _active_reactions;
+    std::vector<unsigned int> _inactive_reactions;
+
+  private:
+
+    ActiveReactions();
+
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType>
+  inline
+  ActiveReactions<CoeffType>::ActiveReactions( const ReactionSet<CoeffType>& reaction_set )
+    : _n_species(0),
+      _concentration_threshold(0),
+      _temperature_threshold(0)
+  {
+    this->build(reaction_set);
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  ActiveReactions<CoeffType>::~ActiveReactions()
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  void ActiveReactions<CoeffType>::set_concentration_threshold( const CoeffType threshold )
+  {
+    _concentration_threshold = threshold;
+  }
+
+  template<typename CoeffType>
+  inline
+  void ActiveReactions<CoeffType>::set_temperature_threshold( const CoeffType threshold )
+  {
+    _temperature_threshold = threshold;
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType ActiveReactions<CoeffType>::concentration_threshold() const
+  {
+    return _concentration_threshold;
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType ActiveReactions<CoeffType>::temperature_threshold() const
+  {
+    return _temperature_threshold;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int ActiveReactions<CoeffType>::n_reactions() const
+  {
+    return _active.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int ActiveReactions<CoeffType>::n_active() const
+  {
+    return _active_reactions.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  bool ActiveReactions<CoeffType>::is_active( const unsigned int rxn ) const
+  {
+    antioch_assert_less( rxn, this->n_reactions() );
+    return _active[rxn];
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& ActiveReactions<CoeffType>::active_reactions() const
+  {
+    return _active_reactions;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& ActiveReactions<CoeffType>::inactive_reactions() const
+  {
+    return _inactive_reactions;
+  }
+
+  template<typename CoeffType>
+  inline
+  void ActiveReactions<CoeffType>::build( const ReactionSet<CoeffType>& reaction_set )
+  {
+    _n_species = reaction_set.n_species();
+    const unsigned int n_reactions = reaction_set.n_reactions();
+
+    // count, then fill, the reactions of each species; a species
+    // appearing several times in a reaction is counted each time,
+    // consistently with update()
+    _reactant_offsets.assign(_n_species + 1,0);
+    _product_offsets.assign(_n_species + 1,0);
+    _reversible.assign(n_reactions,false);
+
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      {
+        const Reaction<CoeffType>& reaction = reaction_set.reaction(rxn);
+        _reversible[rxn] = reaction.reversible();
+
+        for(unsigned int r = 0; r < reaction.n_reactants(); r++)
+          if(reaction.reactant_partial_order(r) != 0)
+            _reactant_offsets[reaction.reactant_id(r) + 1]++;
+
+        if(_reversible[rxn])
+          for(unsigned int p = 0; p < reaction.n_products(); p++)
+            if(reaction.product_partial_order(p) != 0)
+              _product_offsets[reaction.product_id(p) + 1]++;
+      }
+
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        _reactant_offsets[s+1] += _reactant_offsets[s];
+        _product_offsets[s+1]  += _product_offsets[s];
+      }
+
+    _reactant_reactions.resize(_reactant_offsets[_n_species]);
+    _product_reactions.resize(_product_offsets[_n_species]);
+
+    std::vector<unsigned int> reactant_fill(_reactant_offsets.begin(), _reactant_offsets.end() - 1);
+    std::vector<unsigned int> product_fill(_product_offsets.begin(), _product_offsets.end() - 1);
+
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      {
+        const Reaction<CoeffType>& reaction = reaction_set.reaction(rxn);
+
+        for(unsigned int r = 0; r < reaction.n_reactants(); r++)
+          if(reaction.reactant_partial_order(r) != 0)
+            _reactant_reactions[reactant_fill[reaction.reactant_id(r)]++] = rxn;
+
+        if(_reversible[rxn])
+          for(unsigned int p = 0; p < reaction.n_products(); p++)
+            if(reaction.product_partial_order(p) != 0)
+              _product_reactions[product_fill[reaction.product_id(p)]++] = rxn;
+      }
+
+    _absent_reactants.assign(n_reactions,0);
+    _absent_products.assign(n_reactions,0);
+
+    this->activate_all();
+  }
+
+  template<typename CoeffType>
+  inline
+  void ActiveReactions<CoeffType>::activate_all()
+  {
+    const unsigned int n_reactions = _reversible.size();
+
+    _active.assign(n_reactions,true);
+    _active_reactions.resize(n_reactions);
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      _active_reactions[rxn] = rxn;
+    _inactive_reactions.clear();
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void ActiveReactions<CoeffType>::update( const StateType& T, const VectorStateType& molar_densities )
+  {
+    antioch_assert_equal_to( molar_densities.size(), _n_species );
+
+    const unsigned int n_reactions = _reversible.size();
+
+    _active_reactions.clear();
+    _inactive_reactions.clear();
+
+    // frozen chemistry
+    if( T < _temperature_threshold )
+      {
+        _active.assign(n_reactions,false);
+        for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+          _inactive_reactions.push_back(rxn);
+        return;
+      }
+
+    std::fill(_absent_reactants.begin(), _absent_reactants.end(), 0);
+    std::fill(_absent_products.begin(), _absent_products.end(), 0);
+
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        if( molar_densities[s] > _concentration_threshold )
+          continue;
+
+        for(unsigned int i = _reactant_offsets[s]; i < _reactant_offsets[s+1]; i++)
+          _absent_reactants[_reactant_reactions[i]]++;
+        for(unsigned int i = _product_offsets[s]; i < _product_offsets[s+1]; i++)
+          _absent_products[_product_reactions[i]]++;
+      }
+
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      {
+        _active[rxn] = (_absent_reactants[rxn] == 0 ||
+                        (_reversible[rxn] && _absent_products[rxn] == 0));
+
+        if(_active[rxn])
+          _active_reactions.push_back(rxn);
+        else
+          _inactive_reactions.push_back(rxn);
+      }
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_ACTIVE_REACTIONS_H
@@ -0,0 +1,1921 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_COMPILED_REACTION_SET_H
+#define ANTIOCH_COMPILED_REACTION_SET_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/cmath_shims.h"
+#include "antioch/metaprogramming.h"
+#include "antioch/physical_constants.h"
+#include "antioch/reaction_set.h"
+#include "antioch/kinetics_conditions.h"
+#include "antioch/kinetics_workspace.h"
+#include "antioch/log_temperature_table.h"
+
+// C++
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+namespace Antioch
+{
+
+  //! Flat, type-partitioned version of a ReactionSet
+  /*!\class CompiledReactionSet
+   *
+   * The ReactionSet stores every reaction, and every rate constant, as a
+   * separate object, and the evaluation goes through a type switch per
+   * reaction and per rate constant.  This class "compiles" a populated
+   * ReactionSet into contiguous arrays and evaluates the whole mechanism
+   * block by block, without any per-reaction dispatch:
+   *   - every non photochemical rate constant is a slot of the
+   *     Van't Hoff form
+   *     \f$k(T) = C_f \exp\left(\eta \ln(T) - \frac{E_a}{T} + D T\right)\f$,
+   *     the other kinetics models having some of those parameters equal to zero,
+   *   - elementary and duplicate reactions sum their slots,
+   *   - three-body reactions multiply their slot by \f$\sum_s \epsilon_s c_s\f$,
+   *     the distinct sets of efficiencies being stored once, as sparse
+   *     overrides of the default efficiency of 1,
+   *   - Lindemann and Troe falloff reactions use their two slots as
+   *     \f$k_0\f$ and \f$k_\infty\f$,
+   *   - the stoichiometry and partial orders are stored in CSR form.
+   *
+   * The reactions that cannot be expressed this way (photochemistry, explicit
+   * reverse rate constants) are evaluated through their Reaction object.
+   *
+   * The compiled set takes a snapshot of the parameters: if the ReactionSet
+   * is modified afterwards, compile() needs to be called again.
+   *
+   * The temperature dependence of the slots and of the equilibrium constants
+   * can also be tabulated over a temperature range, see tabulate().
+   */
+  template<typename CoeffType=double>
+  class CompiledReactionSet
+  {
+  public:
+
+    //! Constructor, compiles the reaction set.
+    CompiledReactionSet( const ReactionSet<CoeffType>& reaction_set );
+
+    ~CompiledReactionSet();
+
+    //! (Re)build the flat representation from the reaction set.
+    void compile();
+
+    //! \returns the number of species.
+    unsigned int n_species() const;
+
+    //! \returns the number of reactions.
+    unsigned int n_reactions() const;
+
+    //! \returns the number of rate constants slots.
+    unsigned int n_rate_slots() const;
+
+    //! \returns the number of reactions evaluated through their Reaction object.
+    unsigned int n_generic_reactions() const;
+
+    //! \returns the number of distinct sets of efficiencies, including the default one.
+    unsigned int n_efficiency_sets() const;
+
+    const ReactionSet<CoeffType>& reaction_set() const;
+
+    const ChemicalMixture<CoeffType>& chemical_mixture() const;
+
+    //! Tabulates the rate and equilibrium constants between \p T_min and \p T_max
+    /*!
+     * Precomputes \f$\ln\left(\frac{k}{C_f}\right)\f$ for every slot and
+     * \f$\ln\left(K_{eq}\right)\f$ for every reversible reaction, and their
+     * \f$\ln(T)\f$-derivatives, on \p n_points nodes uniformly spaced in
+     * \f$\ln(T)\f$, \p thermo giving the equilibrium constants. Scalar
+     * evaluations within the range then interpolate them by cubic Hermite
+     * polynomials, and ignore their h_RT_minus_s_R arguments for the
+     * compiled reactions. Evaluations outside of the range, and vector-valued
+     * ones, keep using the analytic forms.
+     *
+     * The interpolation errors, estimated between the nodes, are given
+     * by tabulation_rate_error() and tabulation_equilibrium_error().
+     * compile() discards the tables.
+     */
+    template <typename ThermoEvaluator>
+    void tabulate( const ThermoEvaluator& thermo,
+                   const CoeffType T_min,
+                   const CoeffType T_max,
+                   const unsigned int n_points );
+
+    //! Back to the analytic evaluations
+    void clear_tabulation();
+
+    bool tabulated() const;
+
+    //! Largest relative error of the tabulated rate constants
+    CoeffType tabulation_rate_error() const;
+
+    //! Largest relative error of the tabulated equilibrium constants
+    CoeffType tabulation_equilibrium_error() const;
+
+    //! Compute the rates of progress for each reaction
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType>
+    void compute_reaction_rates( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                 const VectorStateType& molar_densities,
+                                 const VectorStateType& h_RT_minus_s_R,
+                                 VectorReactionsType& net_reaction_rates ) const;
+
+    //! Same as above, using the scratch space of \p workspace: no allocation.
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType, typename WorkspaceVectorType>
+    void compute_reaction_rates( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                 const VectorStateType& molar_densities,
+                                 const VectorStateType& h_RT_minus_s_R,
+                                 VectorReactionsType& net_reaction_rates,
+                                 KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const;
+
+    //! Compute the rates of progress and derivatives for each reaction
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType, typename MatrixReactionsType>
+    void compute_reaction_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                            const VectorStateType& molar_densities,
+                                            const VectorStateType& h_RT_minus_s_R,
+                                            const VectorStateType& dh_RT_minus_s_R_dT,
+                                            VectorReactionsType& net_reaction_rates,
+                                            VectorReactionsType& dnet_rate_dT,
+                                            MatrixReactionsType& dnet_rate_dX_s ) const;
+
+    //! Same as above, using the scratch space of \p workspace: no allocation.
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType, typename MatrixReactionsType>
+    void compute_reaction_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                            const VectorStateType& molar_densities,
+                                            const VectorStateType& h_RT_minus_s_R,
+                                            const VectorStateType& dh_RT_minus_s_R_dT,
+                                            VectorReactionsType& net_reaction_rates,
+                                            VectorReactionsType& dnet_rate_dT,
+                                            MatrixReactionsType& dnet_rate_dX_s,
+                                            KineticsWorkspace<StateType,VectorStateType>& workspace ) const;
+
+    //! Compute the rates of progress and their derivatives along a direction
+    /*!
+     * \p dnet_rate_v[r] is \f$\frac{\partial R_r}{\partial T} v_T + \sum_s \frac{\partial R_r}{\partial c_s} v_{X,s}\f$.
+     * The species derivatives of the compiled reactions are never formed:
+     * the \f$[\mathrm{M}]\f$ terms use the efficiency-weighted sum of \p v_X of
+     * their set of efficiencies, so the cost is linear in the number of
+     * reactions. The generic reactions are evaluated by their Reaction object,
+     * in workspace.dnet_rate_dX_s.
+     */
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType>
+    void compute_reaction_rates_jvp( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                     const VectorStateType& molar_densities,
+                                     const VectorStateType& h_RT_minus_s_R,
+                                     const VectorStateType& dh_RT_minus_s_R_dT,
+                                     const StateType& v_T,
+                                     const VectorStateType& v_X,
+                                     VectorReactionsType& net_reaction_rates,
+                                     VectorReactionsType& dnet_rate_v,
+                                     KineticsWorkspace<StateType,VectorStateType>& workspace ) const;
+
+    //! Transpose of compute_reaction_rates_jvp()
+    /*!
+     * \p w_dT is \f$\sum_r w_r \frac{\partial R_r}{\partial T}\f$ and \p w_dX[s] is
+     * \f$\sum_r w_r \frac{\partial R_r}{\partial c_s}\f$, e.g. for the adjoint
+     * of the source terms with \f$w = \nu^T \lambda\f$.
+     */
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType>
+    void compute_reaction_rates_vjp( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                     const VectorStateType& molar_densities,
+                                     const VectorStateType& h_RT_minus_s_R,
+                                     const VectorStateType& dh_RT_minus_s_R_dT,
+                                     const VectorReactionsType& w,
+                                     VectorReactionsType& net_reaction_rates,
+                                     StateType& w_dT,
+                                     VectorStateType& w_dX,
+                                     KineticsWorkspace<StateType,VectorStateType>& workspace ) const;
+
+  protected:
+
+    //! Temperature dependent terms, unless cached, \f$[\mathrm{M}]\f$ of the sets
+    //  of efficiencies and forward rate coefficients with their derivatives, in \p workspace
+    template <typename StateType, typename VectorStateType>
+    void prepare_derivatives( const KineticsConditions<StateType,VectorStateType>& conditions,
+                              const VectorStateType& molar_densities,
+                              const VectorStateType& h_RT_minus_s_R,
+                              const VectorStateType& dh_RT_minus_s_R_dT,
+                              KineticsWorkspace<StateType,VectorStateType>& workspace ) const;
+
+    //! Add a rate constant slot, false if the kinetics model is not compilable
+    bool add_rate_slot( const KineticsType<CoeffType>& rate );
+
+    //! Evaluates all the rate constant slots
+    template <typename StateType, typename VectorStateType>
+    void compute_slot_rates( const KineticsConditions<StateType,VectorStateType>& conditions,
+                             std::vector<StateType>& k_slot ) const;
+
+    //! Evaluates all the rate constant slots and their temperature derivatives
+    template <typename StateType, typename VectorStateType>
+    void compute_slot_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                        std::vector<StateType>& k_slot,
+                                        std::vector<StateType>& dk_slot_dT ) const;
+
+    //! \f$[\mathrm{M}]\f$ of every set of efficiencies
+    /*! The total concentration is computed once, each set only adds its overrides. */
+    template <typename StateType, typename VectorStateType>
+    void compute_collision_concentrations( const VectorStateType& molar_densities,
+                                           std::vector<StateType>& M ) const;
+
+    //! \f$F_{\text{cent}}\f$ and \f$\ln(F_{\text{cent}})\f$ of all the Troe reactions
+    /*! One pass over the packed Troe parameters, without branches. */
+    template <typename StateType>
+    void compute_troe_centers( const StateType& T,
+                               std::vector<StateType>& Fcent,
+                               std::vector<StateType>& logFcent ) const;
+
+    //! Same as above, with the temperature derivative of \f$F_{\text{cent}}\f$
+    template <typename StateType>
+    void compute_troe_centers_and_derivs( const StateType& T,
+                                          std::vector<StateType>& Fcent,
+                                          std::vector<StateType>& logFcent,
+                                          std::vector<StateType>& dFcent_dT ) const;
+
+    //! forward rate coefficients of all the compiled reactions, \p M
+    //  from compute_collision_concentrations(), \p troe_Fcent and
+    //  \p troe_logFcent from compute_troe_centers()
+    template <typename StateType>
+    void compute_forward_rate_coefficients( const std::vector<StateType>& M,
+                                            const std::vector<StateType>& k_slot,
+                                            const std::vector<StateType>& troe_Fcent,
+                                            const std::vector<StateType>& troe_logFcent,
+                                            std::vector<StateType>& kfwd ) const;
+
+    //! forward rate coefficients and derivatives of all the compiled reactions
+    /*!
+     * The concentration derivative is \f$\frac{\partial k}{\partial [\mathrm{M}]}\f$,
+     * the derivative with respect to species \f$s\f$ being this value times
+     * the efficiency of \f$s\f$.  It is zero for reactions that do not depend
+     * on \f$[\mathrm{M}]\f$.
+     */
+    template <typename StateType>
+    void compute_forward_rate_coefficients_and_derivs( const std::vector<StateType>& M,
+                                                       const std::vector<StateType>& k_slot,
+                                                       const std::vector<StateType>& dk_slot_dT,
+                                                       const std::vector<StateType>& troe_Fcent,
+                                                       const std::vector<StateType>& troe_logFcent,
+                                                       const std::vector<StateType>& troe_dFcent_dT,
+                                                       std::vector<StateType>& kfwd,
+                                                       std::vector<StateType>& dkfwd_dT,
+                                                       std::vector<StateType>& dkfwd_dM ) const;
+
+    //! \f$\ln\left(K_{eq}\right) + \gamma \ln\left(\frac{\mathrm{R}T}{P^0}\right)\f$ of reaction \p rxn
+    template <typename StateType, typename VectorStateType>
+    StateType equilibrium_exponent( const unsigned int rxn,
+                                    const VectorStateType& h_RT_minus_s_R ) const;
+
+    //! \f$K_{eq}\f$ of all the reversible compiled reactions
+    template <typename StateType, typename VectorStateType>
+    void compute_equilibrium_constants( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                        const VectorStateType& h_RT_minus_s_R,
+                                        std::vector<StateType>& keq ) const;
+
+    //! \f$K_{eq}\f$ and its temperature derivative for all the reversible compiled reactions
+    template <typename StateType, typename VectorStateType>
+    void compute_equilibrium_constants_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                   const VectorStateType& h_RT_minus_s_R,
+                                                   const VectorStateType& dh_RT_minus_s_R_dT,
+                                                   std::vector<StateType>& keq,
+                                                   std::vector<StateType>& dkeq_dT ) const;
+
+    //! Slots and equilibrium constants from the tables, false if not tabulated at this temperature
+    template <typename StateType>
+    typename enable_if_c<!has_size<StateType>::value,bool>::type
+    lookup_rates( const TempCache<StateType>& cache,
+                  std::vector<StateType>& k_slot,
+                  std::vector<StateType>& keq ) const;
+
+    //! vector-valued temperatures are not looked up
+    template <typename StateType>
+    typename enable_if_c<has_size<StateType>::value,bool>::type
+    lookup_rates( const TempCache<StateType>& cache,
+                  std::vector<StateType>& k_slot,
+                  std::vector<StateType>& keq ) const;
+
+    //! Same as above, with the temperature derivatives
+    template <typename StateType>
+    typename enable_if_c<!has_size<StateType>::value,bool>::type
+    lookup_rates_and_derivs( const TempCache<StateType>& cache,
+                             std::vector<StateType>& k_slot,
+                             std::vector<StateType>& dk_slot_dT,
+                             std::vector<StateType>& keq,
+                             std::vector<StateType>& dkeq_dT ) const;
+
+    template <typename StateType>
+    typename enable_if_c<has_size<StateType>::value,bool>::type
+    lookup_rates_and_derivs( const TempCache<StateType>& cache,
+                             std::vector<StateType>& k_slot,
+                             std::vector<StateType>& dk_slot_dT,
+                             std::vector<StateType>& keq,
+                             std::vector<StateType>& dkeq_dT ) const;
+
+    //! Adds \f$\epsilon_s \frac{\partial R}{\partial [\mathrm{M}]}\f$ to the
+    //  derivatives of reaction \p rxn, visiting the efficiency overrides only
+    template <typename StateType, typename VectorStateType>
+    void add_collision_derivatives( const unsigned int rxn,
+                                    const StateType& dR_dM,
+                                    VectorStateType& dR_dX ) const;
+
+    const ReactionSet<CoeffType>& _reaction_set;
+
+    //! Scaling for equilibrium constant
+    const CoeffType _P0_R;
+
+    //! rate constants slots, \f$k(T) = C_f \exp\left(\eta \ln(T) - \frac{E_a}{T} + D T\right)\f$
+    std::vector<CoeffType> _slot_Cf;
+    std::vector<CoeffType> _slot_eta;
+    std::vector<CoeffType> _slot_Ea;
+    std::vector<CoeffType> _slot_D;
+
+    //! slots of reaction rxn are [_slot_offset[rxn],_slot_offset[rxn+1])
+    std::vector<unsigned int> _slot_offset;
+
+    //! reactants, CSR: reaction rxn has [_reactant_offset[rxn],_reactant_offset[rxn+1])
+    std::vector<unsigned int> _reactant_offset;
+    std::vector<unsigned int> _reactant_ids;
+    std::vector<CoeffType>    _reactant_stoichiometry;
+    std::vector<CoeffType>    _reactant_orders;
+    std::vector<PartialOrder::PartialOrder> _reactant_order_types;
+
+    //! products, CSR: reaction rxn has [_product_offset[rxn],_product_offset[rxn+1])
+    std::vector<unsigned int> _product_offset;
+    std::vector<unsigned int> _product_ids;
+    std::vector<CoeffType>    _product_stoichiometry;
+    std::vector<CoeffType>    _product_orders;
+    std::vector<PartialOrder::PartialOrder> _product_order_types;
+
+    //! \f$\gamma\f$ of reversible reactions, zero else
+    std::vector<CoeffType> _gamma;
+    std::vector<CoeffType> _max_rate;
+
+    //! most reactants or products in a reaction
+    unsigned int _max_participants;
+
+    //! blocks of reactions
+    std::vector<unsigned int> _elementary;   // elementary & duplicate
+    std::vector<unsigned int> _three_body;
+    std::vector<unsigned int> _lindemann;    // Lindemann, with or without efficiencies
+    std::vector<unsigned int> _troe;         // Troe, with or without efficiencies
+    std::vector<unsigned int> _compiled;     // all the above
+    std::vector<unsigned int> _reversible;   // reversible compiled reactions
+    std::vector<unsigned int> _generic;      // evaluated by the Reaction object
+
+    //! Troe parameters, same order as _troe
+    std::vector<TroeFalloff<CoeffType> > _troe_F;
+
+    //! \f$F_{\text{cent}}\f$ parameters of _troe_F, packed. Without
+    //  a \f$T^{**}\f$ term, T2 and its weight are zero.
+    std::vector<CoeffType> _troe_alpha;
+    std::vector<CoeffType> _troe_T1;
+    std::vector<CoeffType> _troe_T2;
+    std::vector<CoeffType> _troe_T3;
+    std::vector<CoeffType> _troe_T2_weight;
+
+    //! reactions depending on [M], with their set of efficiencies
+    std::vector<bool> _collision;
+    std::vector<unsigned int> _efficiency_set;
+
+    //! distinct sets of efficiencies in CSR form, as overrides of the
+    //  default efficiency of 1 stored as \f$\epsilon_s - 1\f$.
+    //  Set 0 has no override.
+    std::vector<unsigned int> _efficiency_offset;
+    std::vector<unsigned int> _efficiency_ids;
+    std::vector<CoeffType>    _efficiency_excess;
+
+    //! \f$\ln\left(\frac{k}{C_f}\right)\f$ of the slots, \f$\ln\left(K_{eq}\right)\f$ of the reversible reactions
+    LogTemperatureTable<CoeffType> _slot_table;
+    LogTemperatureTable<CoeffType> _keq_table;
+
+    CoeffType _slot_table_error;
+    CoeffType _keq_table_error;
+
+  private:
+
+    CompiledReactionSet();
+
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType>
+  inline
+  CompiledReactionSet<CoeffType>::CompiledReactionSet( const ReactionSet<CoeffType>& reaction_set )
+    : _reaction_set(reaction_set),
+      _P0_R(1.0e5/Constants::R_universal<CoeffType>()), //SI
+      _max_participants(0),
+      _slot_table_error(0),
+      _keq_table_error(0)
+  {
+    this->compile();
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  CompiledReactionSet<CoeffType>::~CompiledReactionSet()
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int CompiledReactionSet<CoeffType>::n_species() const
+  {
+    return _reaction_set.n_species();
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int CompiledReactionSet<CoeffType>::n_reactions() const
+  {
+    return _slot_offset.size() - 1;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int CompiledReactionSet<CoeffType>::n_rate_slots() const
+  {
+    return _slot_Cf.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int CompiledReactionSet<CoeffType>::n_generic_reactions() const
+  {
+    return _generic.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int CompiledReactionSet<CoeffType>::n_efficiency_sets() const
+  {
+    return _efficiency_offset.size() - 1;
+  }
+
+  template<typename CoeffType>
+  inline
+  const ReactionSet<CoeffType>& CompiledReactionSet<CoeffType>::reaction_set() const
+  {
+    return _reaction_set;
+  }
+
+  template<typename CoeffType>
+  inline
+  const ChemicalMixture<CoeffType>& CompiledReactionSet<CoeffType>::chemical_mixture() const
+  {
+    return _reaction_set.chemical_mixture();
+  }
+
+  template<typename CoeffType>
+  template <typename ThermoEvaluator>
+  inline
+  void CompiledReactionSet<CoeffType>::tabulate( const ThermoEvaluator& thermo,
+                                                 const CoeffType T_min,
+                                                 const CoeffType T_max,
+                                                 const unsigned int n_points )
+  {
+    std::vector<unsigned int> slots(this->n_rate_slots());
+    for(unsigned int i = 0; i < slots.size(); i++)
+      {
+        slots[i] = i;
+      }
+
+    _slot_table.resize(T_min,T_max,n_points,slots);
+    _keq_table.resize(T_min,T_max,n_points,_reversible);
+
+    std::vector<CoeffType> h_RT_minus_s_R(this->n_species());
+    std::vector<CoeffType> dh_RT_minus_s_R_dT(this->n_species());
+
+    const CoeffType ln_P0_R = ant_log(_P0_R);
+    const CoeffType dlnT = _slot_table.lnT(1) - _slot_table.lnT(0);
+
+    std::vector<CoeffType> ln_k_slot(this->n_rate_slots());
+    std::vector<CoeffType> ln_keq(this->n_reactions());
+
+    _slot_table_error = 0;
+    _keq_table_error = 0;
+
+    // first pass: values and ln(T)-slopes at the nodes,
+    // second pass: errors at three points within each interval
+    for(unsigned int pass = 0; pass < 2; pass++)
+      {
+        for(unsigned int node = 0; node < n_points - pass; node++)
+          {
+            for(unsigned int q = pass; q < 1 + 3*pass; q++)
+              {
+                const CoeffType lnT = _slot_table.lnT(node) + (q * dlnT)/4;
+
+                // exp(ln(T_max)) may round above T_max, and out of the thermo fits
+                const CoeffType T = std::max(T_min, std::min(T_max, CoeffType(ant_exp(lnT))));
+                const TempCache<CoeffType> cache(T);
+
+                thermo.h_RT_minus_s_R(cache,h_RT_minus_s_R);
+                thermo.dh_RT_minus_s_R_dT(cache,dh_RT_minus_s_R_dT);
+
+                if(pass == 1)
+                  {
+                    _slot_table.interpolate(lnT,ln_k_slot);
+                    _keq_table.interpolate(lnT,ln_keq);
+                  }
+
+                for(unsigned int i = 0; i < this->n_rate_slots(); i++)
+                  {
+                    const CoeffType g = _slot_eta[i] * lnT - _slot_Ea[i]/T + _slot_D[i] * T;
+                    if(pass == 0)
+                      {
+                        _slot_table.set(node, i, g, _slot_eta[i] + _slot_Ea[i]/T + _slot_D[i] * T);
+                      }
+                    else
+                      {
+                        _slot_table_error = std::max(_slot_table_error, ant_abs(ln_k_slot[i] - g));
+                      }
+                  }
+
+                for(unsigned int i = 0; i < _reversible.size(); i++)
+                  {
+                    const unsigned int rxn = _reversible[i];
+                    const CoeffType g = _gamma[rxn] * (ln_P0_R - lnT) +
+                                        this->equilibrium_exponent<CoeffType>(rxn,h_RT_minus_s_R);
+                    if(pass == 0)
+                      {
+                        _keq_table.set(node, i, g, - _gamma[rxn] +
+                                       T * this->equilibrium_exponent<CoeffType>(rxn,dh_RT_minus_s_R_dT));
+                      }
+                    else
+                      {
+                        _keq_table_error = std::max(_keq_table_error, ant_abs(ln_keq[rxn] - g));
+                      }
+                  }
+              }
+          }
+      }
+  }
+
+  template<typename CoeffType>
+  inline
+  void CompiledReactionSet<CoeffType>::clear_tabulation()
+  {
+    _slot_table.clear();
+    _keq_table.clear();
+    _slot_table_error = 0;
+    _keq_table_error = 0;
+  }
+
+  template<typename CoeffType>
+  inline
+  bool CompiledReactionSet<CoeffType>::tabulated() const
+  {
+    return !_slot_table.empty();
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType CompiledReactionSet<CoeffType>::tabulation_rate_error() const
+  {
+    // absolute error on ln(k), relative error on k
+    return _slot_table_error;
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType CompiledReactionSet<CoeffType>::tabulation_equilibrium_error() const
+  {
+    return _keq_table_error;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  typename enable_if_c<!has_size<StateType>::value,bool>::type
+  CompiledReactionSet<CoeffType>::lookup_rates( const TempCache<StateType>& cache,
+                                                std::vector<StateType>& k_slot,
+                                                std::vector<StateType>& keq ) const
+  {
+    if( !_slot_table.in_range(cache.T) )
+      {
+        return false;
+      }
+
+    _slot_table.interpolate(cache.lnT,k_slot);
+    for(unsigned int i = 0; i < this->n_rate_slots(); i++)
+      {
+        k_slot[i] = _slot_Cf[i] * ant_exp(k_slot[i]);
+      }
+
+    _keq_table.interpolate(cache.lnT,keq);
+    for(unsigned int i = 0; i < _reversible.size(); i++)
+      {
+        keq[_reversible[i]] = ant_exp(keq[_reversible[i]]);
+      }
+
+    return true;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  typename enable_if_c<has_size<StateType>::value,bool>::type
+  CompiledReactionSet<CoeffType>::lookup_rates( const TempCache<StateType>& /*cache*/,
+                                                std::vector<StateType>& /*k_slot*/,
+                                                std::vector<StateType>& /*keq*/ ) const
+  {
+    return false;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  typename enable_if_c<!has_size<StateType>::value,bool>::type
+  CompiledReactionSet<CoeffType>::lookup_rates_and_derivs( const TempCache<StateType>& cache,
+                                                           std::vector<StateType>& k_slot,
+                                                           std::vector<StateType>& dk_slot_dT,
+                                                           std::vector<StateType>& keq,
+                                                           std::vector<StateType>& dkeq_dT ) const
+  {
+    if( !_slot_table.in_range(cache.T) )
+      {
+        return false;
+      }
+
+    // d/dT = 1/T d/dln(T)
+    _slot_table.interpolate_and_derivs(cache.lnT,k_slot,dk_slot_dT);
+    for(unsigned int i = 0; i < this->n_rate_slots(); i++)
+      {
+        k_slot[i] = _slot_Cf[i] * ant_exp(k_slot[i]);
+        dk_slot_dT[i] *= k_slot[i]/cache.T;
+      }
+
+    _keq_table.interpolate_and_derivs(cache.lnT,keq,dkeq_dT);
+    for(unsigned int i = 0; i < _reversible.size(); i++)
+      {
+        const unsigned int rxn = _reversible[i];
+        keq[rxn] = ant_exp(keq[rxn]);
+        dkeq_dT[rxn] *= keq[rxn]/cache.T;
+      }
+
+    return true;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  typename enable_if_c<has_size<StateType>::value,bool>::type
+  CompiledReactionSet<CoeffType>::lookup_rates_and_derivs( const TempCache<StateType>& /*cache*/,
+                                                           std::vector<StateType>& /*k_slot*/,
+                                                           std::vector<StateType>& /*dk_slot_dT*/,
+                                                           std::vector<StateType>& /*keq*/,
+                                                           std::vector<StateType>& /*dkeq_dT*/ ) const
+  {
+    return false;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void CompiledReactionSet<CoeffType>::add_collision_derivatives( const unsigned int rxn,
+                                                                  const StateType& dR_dM,
+                                                                  VectorStateType& dR_dX ) const
+  {
+    for(unsigned int s = 0; s < this->n_species(); s++)
+      {
+        dR_dX[s] += dR_dM;
+      }
+
+    const unsigned int set = _efficiency_set[rxn];
+    for(unsigned int i = _efficiency_offset[set]; i < _efficiency_offset[set+1]; i++)
+      {
+        dR_dX[_efficiency_ids[i]] += _efficiency_excess[i] * dR_dM;
+      }
+  }
+
+  template<typename CoeffType>
+  inline
+  bool CompiledReactionSet<CoeffType>::add_rate_slot( const KineticsType<CoeffType>& rate )
+  {
+    CoeffType Cf(0), eta(0), Ea(0), D(0);
+
+    switch(rate.type())
+      {
+      case(KineticsModel::CONSTANT):
+        {
+          Cf  = static_cast<const ConstantRate<CoeffType>&>(rate).Cf();
+        }
+        break;
+
+      case(KineticsModel::HERCOURT_ESSEN):
+        {
+          Cf  = static_cast<const HercourtEssenRate<CoeffType>&>(rate).Cf();
+          eta = static_cast<const HercourtEssenRate<CoeffType>&>(rate).eta();
+        }
+        break;
+
+      case(KineticsModel::BERTHELOT):
+        {
+          Cf  = static_cast<const BerthelotRate<CoeffType>&>(rate).Cf();
+          D   = static_cast<const BerthelotRate<CoeffType>&>(rate).D();
+        }
+        break;
+
+      case(KineticsModel::ARRHENIUS):
+        {
+          Cf  = static_cast<const ArrheniusRate<CoeffType>&>(rate).Cf();
+          Ea  = static_cast<const ArrheniusRate<CoeffType>&>(rate).Ea_K();
+        }
+        break;
+
+      case(KineticsModel::BHE):
+        {
+          Cf  = static_cast<const BerthelotHercourtEssenRate<CoeffType>&>(rate).Cf();
+          eta = static_cast<const BerthelotHercourtEssenRate<CoeffType>&>(rate).eta();
+          D   = static_cast<const BerthelotHercourtEssenRate<CoeffType>&>(rate).D();
+        }
+        break;
+
+      case(KineticsModel::KOOIJ):
+        {
+          Cf  = static_cast<const KooijRate<CoeffType>&>(rate).Cf();
+          eta = static_cast<const KooijRate<CoeffType>&>(rate).eta();
+          Ea  = static_cast<const KooijRate<CoeffType>&>(rate).Ea_K();
+        }
+        break;
+
+      case(KineticsModel::VANTHOFF):
+        {
+          Cf  = static_cast<const VantHoffRate<CoeffType>&>(rate).Cf();
+          eta = static_cast<const VantHoffRate<CoeffType>&>(rate).eta();
+          Ea  = static_cast<const VantHoffRate<CoeffType>&>(rate).Ea_K();
+          D   = static_cast<const VantHoffRate<CoeffType>&>(rate).D();
+        }
+        break;
+
+      default: // photochemistry depends on the particle flux
+        {
+          return false;
+        }
+
+      } // switch(rate.type())
+
+    _slot_Cf.push_back(Cf);
+    _slot_eta.push_back(eta);
+    _slot_Ea.push_back(Ea);
+    _slot_D.push_back(D);
+
+    return true;
+  }
+
+  template<typename CoeffType>
+  inline
+  void CompiledReactionSet<CoeffType>::compile()
+  {
+    const unsigned int n_reactions = _reaction_set.n_reactions();
+
+    this->clear_tabulation();
+
+    _slot_Cf.clear();
+    _slot_eta.clear();
+    _slot_Ea.clear();
+    _slot_D.clear();
+    _slot_offset.assign(1,0);
+
+    _reactant_offset.assign(1,0);
+    _reactant_ids.clear();
+    _reactant_stoichiometry.clear();
+    _reactant_orders.clear();
+    _reactant_order_types.clear();
+    _product_offset.assign(1,0);
+    _product_ids.clear();
+    _product_stoichiometry.clear();
+    _product_orders.clear();
+    _product_order_types.clear();
+
+    _gamma.assign(n_reactions,0);
+    _max_rate.assign(n_reactions,std::numeric_limits<CoeffType>::infinity());
+    _max_participants = 0;
+
+    _elementary.clear();
+    _three_body.clear();
+    _lindemann.clear();
+    _troe.clear();
+    _compiled.clear();
+    _reversible.clear();
+    _generic.clear();
+    _troe_F.clear();
+    _troe_alpha.clear();
+    _troe_T1.clear();
+    _troe_T2.clear();
+    _troe_T3.clear();
+    _troe_T2_weight.clear();
+
+    _collision.assign(n_reactions,false);
+    _efficiency_set.assign(n_reactions,0);
+    _efficiency_offset.assign(2,0);
+    _efficiency_ids.clear();
+    _efficiency_excess.clear();
+
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      {
+        const Reaction<CoeffType>& reaction = _reaction_set.reaction(rxn);
+
+        // stoichiometry
+        for(unsigned int r = 0; r < reaction.n_reactants(); r++)
+          {
+            _reactant_ids.push_back(reaction.reactant_id(r));
+            _reactant_stoichiometry.push_back(static_cast<CoeffType>(reaction.reactant_stoichiometric_coefficient(r)));
+            _reactant_orders.push_back(reaction.reactant_partial_order(r));
+            _reactant_order_types.push_back(reaction.reactant_partial_order_type(r));
+          }
+        _reactant_offset.push_back(_reactant_ids.size());
+
+        for(unsigned int p = 0; p < reaction.n_products(); p++)
+          {
+            _product_ids.push_back(reaction.product_id(p));
+            _product_stoichiometry.push_back(static_cast<CoeffType>(reaction.product_stoichiometric_coefficient(p)));
+            _product_orders.push_back(reaction.product_partial_order(p));
+            _product_order_types.push_back(reaction.product_partial_order_type(p));
+          }
+        _product_offset.push_back(_product_ids.size());
+
+        _max_participants = std::max(_max_participants,std::max(reaction.n_reactants(),reaction.n_products()));
+
+        // rate constants, if one is not compilable, or if the reverse
+        // rate constant is explicit, the reaction is generic
+        bool compilable(!reaction.has_reverse_rate());
+        const unsigned int first_slot = _slot_Cf.size();
+        for(unsigned int ir = 0; ir < reaction.n_rate_constants(); ir++)
+          {
+            compilable = this->add_rate_slot(reaction.forward_rate(ir)) && compilable;
+          }
+
+        if(!compilable)
+          {
+            _slot_Cf.resize(first_slot);
+            _slot_eta.resize(first_slot);
+            _slot_Ea.resize(first_slot);
+            _slot_D.resize(first_slot);
+            _slot_offset.push_back(first_slot);
+
+            _generic.push_back(rxn);
+            continue;
+          }
+        _slot_offset.push_back(_slot_Cf.size());
+
+        // chemical process
+        bool efficiencies(false);
+        switch(reaction.type())
+          {
+          case(ReactionType::ELEMENTARY):
+          case(ReactionType::DUPLICATE):
+            {
+              _elementary.push_back(rxn);
+            }
+            break;
+
+          case(ReactionType::THREE_BODY):
+            {
+              _three_body.push_back(rxn);
+              efficiencies = true;
+            }
+            break;
+
+          case(ReactionType::LINDEMANN_FALLOFF_THREE_BODY):
+            {
+              efficiencies = true;
+            }
+          case(ReactionType::LINDEMANN_FALLOFF):
+            {
+              antioch_assert_equal_to(reaction.n_rate_constants(),2);
+              _lindemann.push_back(rxn);
+            }
+            break;
+
+          case(ReactionType::TROE_FALLOFF):
+            {
+              antioch_assert_equal_to(reaction.n_rate_constants(),2);
+              _troe.push_back(rxn);
+              _troe_F.push_back(static_cast<const FalloffReaction<CoeffType,TroeFalloff<CoeffType> >&>(reaction).F());
+            }
+            break;
+
+          case(ReactionType::TROE_FALLOFF_THREE_BODY):
+            {
+              antioch_assert_equal_to(reaction.n_rate_constants(),2);
+              _troe.push_back(rxn);
+              _troe_F.push_back(static_cast<const FalloffThreeBodyReaction<CoeffType,TroeFalloff<CoeffType> >&>(reaction).F());
+              efficiencies = true;
+            }
+            break;
+
+          default:
+            {
+              antioch_error();
+            }
+
+          } // switch(reaction.type())
+
+        _collision[rxn] = (reaction.type() != ReactionType::ELEMENTARY &&
+                           reaction.type() != ReactionType::DUPLICATE);
+
+        // reuse an identical set of efficiencies if there is one
+        if(efficiencies && reaction.n_efficiency_overrides() > 0)
+          {
+            const unsigned int n_overrides = reaction.n_efficiency_overrides();
+            const unsigned int n_sets = this->n_efficiency_sets();
+
+            unsigned int set = 1;
+            for(; set < n_sets; set++)
+              {
+                const unsigned int e0 = _efficiency_offset[set];
+                if(_efficiency_offset[set+1] - e0 != n_overrides)
+                  continue;
+
+                bool same(true);
+                for(unsigned int i = 0; i < n_overrides && same; i++)
+                  {
+                    same = (_efficiency_ids[e0 + i] == reaction.efficiency_override_id(i) &&
+                            _efficiency_excess[e0 + i] == reaction.efficiency_override(i) - 1);
+                  }
+                if(same)
+                  break;
+              }
+
+            if(set == n_sets)
+              {
+                for(unsigned int i = 0; i < n_overrides; i++)
+                  {
+                    _efficiency_ids.push_back(reaction.efficiency_override_id(i));
+                    _efficiency_excess.push_back(reaction.efficiency_override(i) - 1);
+                  }
+                _efficiency_offset.push_back(_efficiency_ids.size());
+              }
+
+            _efficiency_set[rxn] = set;
+          }
+
+        _compiled.push_back(rxn);
+        _max_rate[rxn] = reaction.maximum_rate();
+        if(reaction.reversible())
+          {
+            _reversible.push_back(rxn);
+            _gamma[rxn] = static_cast<CoeffType>(reaction.gamma());
+          }
+      }
+
+    for(unsigned int i = 0; i < _troe_F.size(); i++)
+      {
+        const bool has_T2 = (_troe_F[i].get_T2() != std::numeric_limits<CoeffType>::max());
+        _troe_alpha.push_back(_troe_F[i].get_alpha());
+        _troe_T1.push_back(_troe_F[i].get_T1());
+        _troe_T2.push_back(has_T2 ? _troe_F[i].get_T2() : 0);
+        _troe_T3.push_back(_troe_F[i].get_T3());
+        _troe_T2_weight.push_back(has_T2 ? 1 : 0);
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_slot_rates( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                           std::vector<StateType>& k_slot ) const
+  {
+    const StateType& T   = conditions.T();
+    const StateType& lnT = conditions.temp_cache().lnT;
+
+    for(unsigned int i = 0; i < this->n_rate_slots(); i++)
+      {
+        k_slot[i] = _slot_Cf[i] * ant_exp(_slot_eta[i] * lnT - _slot_Ea[i]/T + _slot_D[i] * T);
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_slot_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                      std::vector<StateType>& k_slot,
+                                                                      std::vector<StateType>& dk_slot_dT ) const
+  {
+    const StateType& T   = conditions.T();
+    const StateType& T2  = conditions.temp_cache().T2;
+    const StateType& lnT = conditions.temp_cache().lnT;
+
+    for(unsigned int i = 0; i < this->n_rate_slots(); i++)
+      {
+        k_slot[i] = _slot_Cf[i] * ant_exp(_slot_eta[i] * lnT - _slot_Ea[i]/T + _slot_D[i] * T);
+        dk_slot_dT[i] = k_slot[i] * (_slot_D[i] + _slot_eta[i]/T + _slot_Ea[i]/T2);
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_collision_concentrations( const VectorStateType& molar_densities,
+                                                                         std::vector<StateType>& M ) const
+  {
+    antioch_assert_greater_equal( M.size(), this->n_efficiency_sets() );
+
+    // [M] = sum_s X_s + sum_overrides (eff_s - 1) * X_s
+    M[0] = Antioch::zero_clone(molar_densities[0]);
+    for(unsigned int s = 0; s < this->n_species(); s++)
+      {
+        M[0] += molar_densities[s];
+      }
+
+    for(unsigned int set = 1; set < this->n_efficiency_sets(); set++)
+      {
+        M[set] = M[0];
+        for(unsigned int i = _efficiency_offset[set]; i < _efficiency_offset[set+1]; i++)
+          {
+            M[set] += _efficiency_excess[i] * molar_densities[_efficiency_ids[i]];
+          }
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_troe_centers( const StateType& T,
+                                                             std::vector<StateType>& Fcent,
+                                                             std::vector<StateType>& logFcent ) const
+  {
+    antioch_assert_greater_equal( Fcent.size(), _troe.size() );
+    antioch_assert_greater_equal( logFcent.size(), _troe.size() );
+
+    // Fcent = (1.-alpha)*exp(-T/T***) + alpha * exp(-T/T*) + exp(-T**/T)
+    for(unsigned int i = 0; i < _troe.size(); i++)
+      {
+        Fcent[i] = (1 - _troe_alpha[i]) * ant_exp(-T/_troe_T3[i]) + _troe_alpha[i] * ant_exp(-T/_troe_T1[i])
+                 + _troe_T2_weight[i] * ant_exp(-_troe_T2[i]/T);
+      }
+
+    for(unsigned int i = 0; i < _troe.size(); i++)
+      {
+        antioch_assert(!has_nan(Fcent[i]));
+        logFcent[i] = ant_log(Fcent[i]);
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_troe_centers_and_derivs( const StateType& T,
+                                                                        std::vector<StateType>& Fcent,
+                                                                        std::vector<StateType>& logFcent,
+                                                                        std::vector<StateType>& dFcent_dT ) const
+  {
+    antioch_assert_greater_equal( Fcent.size(), _troe.size() );
+    antioch_assert_greater_equal( logFcent.size(), _troe.size() );
+    antioch_assert_greater_equal( dFcent_dT.size(), _troe.size() );
+
+    for(unsigned int i = 0; i < _troe.size(); i++)
+      {
+        const StateType e3 = ant_exp(-T/_troe_T3[i]);
+        const StateType e1 = ant_exp(-T/_troe_T1[i]);
+        const StateType e2 = _troe_T2_weight[i] * ant_exp(-_troe_T2[i]/T);
+
+        Fcent[i]     = (1 - _troe_alpha[i]) * e3 + _troe_alpha[i] * e1 + e2;
+        dFcent_dT[i] = (_troe_alpha[i] - 1)/_troe_T3[i] * e3 - _troe_alpha[i]/_troe_T1[i] * e1
+                     + _troe_T2[i]/(T*T) * e2;
+      }
+
+    for(unsigned int i = 0; i < _troe.size(); i++)
+      {
+        antioch_assert(!has_nan(Fcent[i]));
+        logFcent[i] = ant_log(Fcent[i]);
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_forward_rate_coefficients( const std::vector<StateType>& M,
+                                                                          const std::vector<StateType>& k_slot,
+                                                                          const std::vector<StateType>& troe_Fcent,
+                                                                          const std::vector<StateType>& troe_logFcent,
+                                                                          std::vector<StateType>& kfwd ) const
+  {
+    // elementary & duplicate: sum of slots
+    for(unsigned int i = 0; i < _elementary.size(); i++)
+      {
+        const unsigned int rxn = _elementary[i];
+        kfwd[rxn] = k_slot[_slot_offset[rxn]];
+        for(unsigned int j = _slot_offset[rxn] + 1; j < _slot_offset[rxn+1]; j++)
+          {
+            kfwd[rxn] += k_slot[j];
+          }
+      }
+
+    // three body: (sum_s eff_s * X_s) * alpha(T)
+    for(unsigned int i = 0; i < _three_body.size(); i++)
+      {
+        const unsigned int rxn = _three_body[i];
+        kfwd[rxn] = M[_efficiency_set[rxn]] * k_slot[_slot_offset[rxn]];
+      }
+
+    // falloff: k0 * ([M]^-1 + k0 * kinf^-1)^-1 * F
+    for(unsigned int i = 0; i < _lindemann.size(); i++)
+      {
+        const unsigned int rxn = _lindemann[i];
+        const StateType& k0   = k_slot[_slot_offset[rxn]];
+        const StateType& kinf = k_slot[_slot_offset[rxn] + 1];
+        const StateType& Mr   = M[_efficiency_set[rxn]];
+
+        kfwd[rxn] = k0 / (ant_pow(Mr,-1) + k0 / kinf);
+      }
+
+    for(unsigned int i = 0; i < _troe.size(); i++)
+      {
+        const unsigned int rxn = _troe[i];
+        const StateType& k0   = k_slot[_slot_offset[rxn]];
+        const StateType& kinf = k_slot[_slot_offset[rxn] + 1];
+        const StateType& Mr   = M[_efficiency_set[rxn]];
+
+        kfwd[rxn] = k0 / (ant_pow(Mr,-1) + k0 / kinf)
+                  * _troe_F[i].F_from_Fcent(Mr,k0,kinf,troe_Fcent[i],troe_logFcent[i]);
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_forward_rate_coefficients_and_derivs( const std::vector<StateType>& M,
+                                                                                     const std::vector<StateType>& k_slot,
+                                                                                     const std::vector<StateType>& dk_slot_dT,
+                                                                                     const std::vector<StateType>& troe_Fcent,
+                                                                                     const std::vector<StateType>& troe_logFcent,
+                                                                                     const std::vector<StateType>& troe_dFcent_dT,
+                                                                                     std::vector<StateType>& kfwd,
+                                                                                     std::vector<StateType>& dkfwd_dT,
+                                                                                     std::vector<StateType>& dkfwd_dM ) const
+  {
+    for(unsigned int i = 0; i < _elementary.size(); i++)
+      {
+        const unsigned int rxn = _elementary[i];
+        kfwd[rxn]     = k_slot[_slot_offset[rxn]];
+        dkfwd_dT[rxn] = dk_slot_dT[_slot_offset[rxn]];
+        for(unsigned int j = _slot_offset[rxn] + 1; j < _slot_offset[rxn+1]; j++)
+          {
+            kfwd[rxn]     += k_slot[j];
+            dkfwd_dT[rxn] += dk_slot_dT[j];
+          }
+        Antioch::set_zero(dkfwd_dM[rxn]);
+      }
+
+    //dk_dT = dalpha_dT * [sum_s (eps_s * X_s)]
+    //dk_dM = alpha(T)
+    for(unsigned int i = 0; i < _three_body.size(); i++)
+      {
+        const unsigned int rxn = _three_body[i];
+        const StateType& Mr = M[_efficiency_set[rxn]];
+        kfwd[rxn]     = Mr * k_slot[_slot_offset[rxn]];
+        dkfwd_dT[rxn] = Mr * dk_slot_dT[_slot_offset[rxn]];
+        dkfwd_dM[rxn] = k_slot[_slot_offset[rxn]];
+      }
+
+    // falloff, see FalloffReaction for the derivatives
+    for(unsigned int b = 0; b < 2; b++)
+      {
+        const std::vector<unsigned int>& block = (b == 0)?_lindemann:_troe;
+        for(unsigned int i = 0; i < block.size(); i++)
+          {
+            const unsigned int rxn = block[i];
+            const StateType& k0       = k_slot[_slot_offset[rxn]];
+            const StateType& dk0_dT   = dk_slot_dT[_slot_offset[rxn]];
+            const StateType& kinf     = k_slot[_slot_offset[rxn] + 1];
+            const StateType& dkinf_dT = dk_slot_dT[_slot_offset[rxn] + 1];
+            const StateType& Mr       = M[_efficiency_set[rxn]];
+
+            StateType f     = Antioch::constant_clone(Mr,1);
+            StateType df_dT = Antioch::zero_clone(Mr);
+            StateType df_dM = Antioch::zero_clone(Mr);
+            if(b == 1)
+              {
+                _troe_F[i].F_and_derivatives_from_Fcent(Mr,k0,dk0_dT,kinf,dkinf_dT,
+                                                        troe_Fcent[i],troe_logFcent[i],troe_dFcent_dT[i],
+                                                        f,df_dT,df_dM);
+              }
+
+            const StateType k = k0 / (ant_pow(Mr,-1) + k0/kinf);
+            const StateType temp = (kinf/Mr + k0);
+
+            dkfwd_dT[rxn] = f * k * (dk0_dT/k0 - dk0_dT/temp + dkinf_dT * k0/(kinf * temp))
+                          + df_dT * k;
+            dkfwd_dM[rxn] = f * k / (Mr + ant_pow(Mr,2) * k0/kinf) + df_dM * k;
+            kfwd[rxn] = k * f;
+          }
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  StateType CompiledReactionSet<CoeffType>::equilibrium_exponent( const unsigned int rxn,
+                                                                  const VectorStateType& h_RT_minus_s_R ) const
+  {
+    // exppower = -DrG0 = reactants - products
+    StateType exppower = Antioch::zero_clone(h_RT_minus_s_R[0]);
+    for(unsigned int r = _reactant_offset[rxn]; r < _reactant_offset[rxn+1]; r++)
+      {
+        exppower += _reactant_stoichiometry[r] * h_RT_minus_s_R[_reactant_ids[r]];
+      }
+    for(unsigned int p = _product_offset[rxn]; p < _product_offset[rxn+1]; p++)
+      {
+        exppower -= _product_stoichiometry[p] * h_RT_minus_s_R[_product_ids[p]];
+      }
+
+    return exppower;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_equilibrium_constants( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                      const VectorStateType& h_RT_minus_s_R,
+                                                                      std::vector<StateType>& keq ) const
+  {
+    const StateType P0_RT = _P0_R/conditions.T();
+
+    for(unsigned int i = 0; i < _reversible.size(); i++)
+      {
+        const unsigned int rxn = _reversible[i];
+        keq[rxn] = ant_pow(P0_RT,_gamma[rxn]) *
+                   ant_exp(this->equilibrium_exponent<StateType>(rxn,h_RT_minus_s_R));
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_equilibrium_constants_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                                 const VectorStateType& h_RT_minus_s_R,
+                                                                                 const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                                 std::vector<StateType>& keq,
+                                                                                 std::vector<StateType>& dkeq_dT ) const
+  {
+    const StateType& T = conditions.T();
+    const StateType P0_RT = _P0_R/T;
+
+    for(unsigned int i = 0; i < _reversible.size(); i++)
+      {
+        const unsigned int rxn = _reversible[i];
+        keq[rxn] = ant_pow(P0_RT,_gamma[rxn]) *
+                   ant_exp(this->equilibrium_exponent<StateType>(rxn,h_RT_minus_s_R));
+        dkeq_dT[rxn] = keq[rxn] * (- _gamma[rxn]/T + this->equilibrium_exponent<StateType>(rxn,dh_RT_minus_s_R_dT));
+      }
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_reaction_rates( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                               const VectorStateType& molar_densities,
+                                                               const VectorStateType& h_RT_minus_s_R,
+                                                               VectorReactionsType& net_reaction_rates ) const
+  {
+    KineticsWorkspace<StateType> workspace(_reaction_set, conditions.T());
+
+    this->compute_reaction_rates( conditions, molar_densities, h_RT_minus_s_R, net_reaction_rates, workspace );
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType, typename WorkspaceVectorType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_reaction_rates( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                               const VectorStateType& molar_densities,
+                                                               const VectorStateType& h_RT_minus_s_R,
+                                                               VectorReactionsType& net_reaction_rates,
+                                                               KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const
+  {
+    antioch_assert_equal_to( net_reaction_rates.size(), this->n_reactions() );
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+
+    const StateType& T = conditions.T();
+
+    // useful constants
+    const StateType P0_RT = _P0_R/T; // used to transform equilibrium constant from pressure units
+
+    antioch_assert_greater_equal( workspace.k_slot.size(), this->n_rate_slots() );
+    antioch_assert_equal_to( workspace.kfwd.size(), this->n_reactions() );
+    antioch_assert_equal_to( workspace.keq.size(), this->n_reactions() );
+
+    std::vector<StateType>& k_slot = workspace.k_slot;
+    std::vector<StateType>& kfwd   = workspace.kfwd;
+    const std::vector<StateType>& keq = workspace.keq;
+
+    // temperature dependent terms, unless cached
+    if( !workspace.temperature_cache_hit(T,false) )
+      {
+        if( !this->lookup_rates(conditions.temp_cache(),k_slot,workspace.keq) )
+          {
+            this->compute_slot_rates(conditions,k_slot);
+            this->compute_equilibrium_constants(conditions,h_RT_minus_s_R,workspace.keq);
+          }
+        this->compute_troe_centers(T,workspace.troe_Fcent,workspace.troe_logFcent);
+        workspace.store_temperature(T,false);
+      }
+
+    this->compute_collision_concentrations(molar_densities,workspace.collision_M);
+    this->compute_forward_rate_coefficients(workspace.collision_M,k_slot,
+                                            workspace.troe_Fcent,workspace.troe_logFcent,kfwd);
+
+    // forward rates of progress
+    for(unsigned int i = 0; i < _compiled.size(); i++)
+      {
+        const unsigned int rxn = _compiled[i];
+        net_reaction_rates[rxn] = kfwd[rxn];
+        for(unsigned int r = _reactant_offset[rxn]; r < _reactant_offset[rxn+1]; r++)
+          {
+            net_reaction_rates[rxn] *= concentration_power(molar_densities[_reactant_ids[r]],_reactant_order_types[r],_reactant_orders[r]);
+          }
+      }
+
+    // backward rates of progress
+    for(unsigned int i = 0; i < _reversible.size(); i++)
+      {
+        const unsigned int rxn = _reversible[i];
+        const StateType& Keq = keq[rxn];
+
+        StateType kbkwd_times_products = kfwd[rxn]/Keq;
+        for(unsigned int p = _product_offset[rxn]; p < _product_offset[rxn+1]; p++)
+          {
+            kbkwd_times_products *= concentration_power(molar_densities[_product_ids[p]],_product_order_types[p],_product_orders[p]);
+          }
+
+        // If we have an equilibrium constant of zero, our reverse
+        // reaction rate should be infinity, not NaN.
+        typename Antioch::rebind<StateType,bool>::type is_nonzero = (Keq != Antioch::zero_clone(Keq));
+        kbkwd_times_products =
+          Antioch::if_else(is_nonzero, kbkwd_times_products,
+                           Antioch::constant_clone(Keq, _max_rate[rxn]));
+
+        net_reaction_rates[rxn] -= kbkwd_times_products;
+      }
+
+    // everything else
+    for(unsigned int i = 0; i < _generic.size(); i++)
+      {
+        const unsigned int rxn = _generic[i];
+        net_reaction_rates[rxn] = _reaction_set.reaction(rxn).compute_rate_of_progress(molar_densities, conditions, P0_RT, h_RT_minus_s_R);
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType, typename MatrixReactionsType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_reaction_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                          const VectorStateType& molar_densities,
+                                                                          const VectorStateType& h_RT_minus_s_R,
+                                                                          const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                          VectorReactionsType& net_reaction_rates,
+                                                                          VectorReactionsType& dnet_rate_dT,
+                                                                          MatrixReactionsType& dnet_rate_dX_s ) const
+  {
+    KineticsWorkspace<StateType,VectorStateType> workspace(_reaction_set, conditions.T());
+
+    this->compute_reaction_rates_and_derivs( conditions, molar_densities, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                             net_reaction_rates, dnet_rate_dT, dnet_rate_dX_s, workspace );
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType>
+  inline
+  void CompiledReactionSet<CoeffType>::prepare_derivatives( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                            const VectorStateType& molar_densities,
+                                                            const VectorStateType& h_RT_minus_s_R,
+                                                            const VectorStateType& dh_RT_minus_s_R_dT,
+                                                            KineticsWorkspace<StateType,VectorStateType>& workspace ) const
+  {
+    const StateType& T = conditions.T();
+
+    antioch_assert_greater_equal( workspace.k_slot.size(), this->n_rate_slots() );
+    antioch_assert_greater_equal( workspace.val.size(), _max_participants );
+    antioch_assert_equal_to( workspace.keq.size(), this->n_reactions() );
+
+    std::vector<StateType>& k_slot     = workspace.k_slot;
+    std::vector<StateType>& dk_slot_dT = workspace.dk_slot_dT;
+
+    // temperature dependent terms, unless cached
+    if( !workspace.temperature_cache_hit(T,true) )
+      {
+        if( !this->lookup_rates_and_derivs(conditions.temp_cache(),k_slot,dk_slot_dT,
+                                           workspace.keq,workspace.dkeq_dT) )
+          {
+            this->compute_slot_rates_and_derivs(conditions,k_slot,dk_slot_dT);
+            this->compute_equilibrium_constants_and_derivs(conditions,h_RT_minus_s_R,dh_RT_minus_s_R_dT,
+                                                           workspace.keq,workspace.dkeq_dT);
+          }
+        this->compute_troe_centers_and_derivs(T,workspace.troe_Fcent,workspace.troe_logFcent,
+                                              workspace.troe_dFcent_dT);
+        workspace.store_temperature(T,true);
+      }
+
+    this->compute_collision_concentrations(molar_densities,workspace.collision_M);
+    this->compute_forward_rate_coefficients_and_derivs(workspace.collision_M,k_slot,dk_slot_dT,
+                                                       workspace.troe_Fcent,workspace.troe_logFcent,
+                                                       workspace.troe_dFcent_dT,
+                                                       workspace.kfwd,workspace.dkfwd_dT,workspace.dkfwd_dM);
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType, typename MatrixReactionsType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_reaction_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                          const VectorStateType& molar_densities,
+                                                                          const VectorStateType& h_RT_minus_s_R,
+                                                                          const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                          VectorReactionsType& net_reaction_rates,
+                                                                          VectorReactionsType& dnet_rate_dT,
+                                                                          MatrixReactionsType& dnet_rate_dX_s,
+                                                                          KineticsWorkspace<StateType,VectorStateType>& workspace ) const
+  {
+    antioch_assert_equal_to( net_reaction_rates.size(), this->n_reactions() );
+    antioch_assert_equal_to( dnet_rate_dT.size(), this->n_reactions() );
+    antioch_assert_equal_to( dnet_rate_dX_s.size(), this->n_reactions() );
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+    antioch_assert_equal_to( dh_RT_minus_s_R_dT.size(), this->n_species() );
+
+    const StateType& T = conditions.T();
+
+    // useful constants
+    const StateType P0_RT = _P0_R/T; // used to transform equilibrium constant from pressure units
+
+    std::vector<StateType>& kfwd       = workspace.kfwd;
+    std::vector<StateType>& dkfwd_dT   = workspace.dkfwd_dT;
+    std::vector<StateType>& dkfwd_dM   = workspace.dkfwd_dM;
+    std::vector<StateType>& val        = workspace.val;
+    std::vector<StateType>& dval       = workspace.dval;
+
+    this->prepare_derivatives(conditions,molar_densities,h_RT_minus_s_R,dh_RT_minus_s_R_dT,workspace);
+
+    // forward rates of progress
+    for(unsigned int i = 0; i < _compiled.size(); i++)
+      {
+        const unsigned int rxn = _compiled[i];
+        const unsigned int r0 = _reactant_offset[rxn];
+        const unsigned int nr = _reactant_offset[rxn+1] - r0;
+
+        Antioch::set_zero(dnet_rate_dX_s[rxn]);
+
+        StateType facfwd = Antioch::constant_clone(T,1);
+        for(unsigned int ro = 0; ro < nr; ro++)
+          {
+            val[ro]  = concentration_power(molar_densities[_reactant_ids[r0 + ro]],
+                                           _reactant_order_types[r0 + ro], _reactant_orders[r0 + ro]);
+            dval[ro] = _reactant_stoichiometry[r0 + ro] *
+                       concentration_power_minus_one(molar_densities[_reactant_ids[r0 + ro]],
+                                                     _reactant_order_types[r0 + ro], _reactant_orders[r0 + ro]);
+            facfwd *= val[ro];
+          }
+
+        for(unsigned int ro = 0; ro < nr; ro++)
+          {
+            StateType dRfwd_dX = kfwd[rxn] * dval[ro];
+            for(unsigned int ri = 0; ri < nr; ri++)
+              {
+                if(ri != ro)
+                  {
+                    dRfwd_dX *= val[ri];
+                  }
+              }
+            dnet_rate_dX_s[rxn][_reactant_ids[r0 + ro]] = dRfwd_dX;
+          }
+
+        if(_collision[rxn])
+          {
+            const StateType dRfwd_dM = facfwd * dkfwd_dM[rxn];
+            this->add_collision_derivatives(rxn,dRfwd_dM,dnet_rate_dX_s[rxn]);
+          }
+
+        net_reaction_rates[rxn] = facfwd * kfwd[rxn];
+        dnet_rate_dT[rxn]       = facfwd * dkfwd_dT[rxn];
+      }
+
+    // backward rates of progress
+    for(unsigned int i = 0; i < _reversible.size(); i++)
+      {
+        const unsigned int rxn = _reversible[i];
+        const unsigned int p0 = _product_offset[rxn];
+        const unsigned int np = _product_offset[rxn+1] - p0;
+
+        const StateType& keq     = workspace.keq[rxn];
+        const StateType& dkeq_dT = workspace.dkeq_dT[rxn];
+
+        const StateType kbkwd = kfwd[rxn]/keq;
+        const StateType dkbkwd_dT = (dkfwd_dT[rxn] - kbkwd*dkeq_dT)/keq;
+
+        StateType facbkwd = Antioch::constant_clone(T,1);
+        for(unsigned int po = 0; po < np; po++)
+          {
+            val[po]  = concentration_power(molar_densities[_product_ids[p0 + po]],
+                                           _product_order_types[p0 + po], _product_orders[p0 + po]);
+            dval[po] = _product_stoichiometry[p0 + po] *
+                       concentration_power_minus_one(molar_densities[_product_ids[p0 + po]],
+                                                     _product_order_types[p0 + po], _product_orders[p0 + po]);
+            facbkwd *= val[po];
+          }
+
+        // If we have an equilibrium constant of zero, our reverse
+        // reaction rate should be infinity, not NaN, and
+        // if our rate is maxed out then our derivatives are zero.
+        typename Antioch::rebind<StateType,bool>::type is_nonzero = (keq != Antioch::zero_clone(keq));
+
+        for(unsigned int po = 0; po < np; po++)
+          {
+            StateType dRbkwd_dX = kbkwd * dval[po];
+            for(unsigned int pi = 0; pi < np; pi++)
+              {
+                if(pi != po)
+                  {
+                    dRbkwd_dX *= val[pi];
+                  }
+              }
+            dnet_rate_dX_s[rxn][_product_ids[p0 + po]] -= Antioch::if_else(is_nonzero, dRbkwd_dX, Antioch::zero_clone(keq));
+          }
+
+        if(_collision[rxn])
+          {
+            StateType dRbkwd_dM = facbkwd * dkfwd_dM[rxn] / keq;
+            dRbkwd_dM = - Antioch::if_else(is_nonzero, dRbkwd_dM, Antioch::zero_clone(keq));
+            this->add_collision_derivatives(rxn,dRbkwd_dM,dnet_rate_dX_s[rxn]);
+          }
+
+        const StateType Rbkwd = facbkwd * kbkwd;
+        const StateType dRbkwd_dT = facbkwd * dkbkwd_dT;
+        net_reaction_rates[rxn] -= Antioch::if_else(is_nonzero, Rbkwd,
+                                                    Antioch::constant_clone(keq, _max_rate[rxn]));
+        dnet_rate_dT[rxn]       -= Antioch::if_else(is_nonzero, dRbkwd_dT,
+                                                    Antioch::zero_clone(keq));
+      }
+
+    // everything else
+    for(unsigned int i = 0; i < _generic.size(); i++)
+      {
+        const unsigned int rxn = _generic[i];
+        _reaction_set.reaction(rxn).compute_rate_of_progress_and_derivatives( molar_densities, this->chemical_mixture(),
+                                                                              conditions, P0_RT, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                                              net_reaction_rates[rxn],
+                                                                              dnet_rate_dT[rxn],
+                                                                              dnet_rate_dX_s[rxn],
+                                                                              workspace.dkfwd_dX_s );
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_reaction_rates_jvp( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                   const VectorStateType& molar_densities,
+                                                                   const VectorStateType& h_RT_minus_s_R,
+                                                                   const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                   const StateType& v_T,
+                                                                   const VectorStateType& v_X,
+                                                                   VectorReactionsType& net_reaction_rates,
+                                                                   VectorReactionsType& dnet_rate_v,
+                                                                   KineticsWorkspace<StateType,VectorStateType>& workspace ) const
+  {
+    antioch_assert_equal_to( net_reaction_rates.size(), this->n_reactions() );
+    antioch_assert_equal_to( dnet_rate_v.size(), this->n_reactions() );
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( v_X.size(), this->n_species() );
+    antioch_assert_greater_equal( workspace.collision_direction.size(), this->n_efficiency_sets() );
+
+    const StateType& T = conditions.T();
+
+    // useful constants
+    const StateType P0_RT = _P0_R/T; // used to transform equilibrium constant from pressure units
+
+    std::vector<StateType>& kfwd       = workspace.kfwd;
+    std::vector<StateType>& dkfwd_dT   = workspace.dkfwd_dT;
+    std::vector<StateType>& dkfwd_dM   = workspace.dkfwd_dM;
+    std::vector<StateType>& val        = workspace.val;
+    std::vector<StateType>& dval       = workspace.dval;
+
+    this->prepare_derivatives(conditions,molar_densities,h_RT_minus_s_R,dh_RT_minus_s_R_dT,workspace);
+
+    // [M] is linear in the concentrations
+    std::vector<StateType>& v_M = workspace.collision_direction;
+    this->compute_collision_concentrations(v_X,v_M);
+
+    // forward rates of progress
+    for(unsigned int i = 0; i < _compiled.size(); i++)
+      {
+        const unsigned int rxn = _compiled[i];
+        const unsigned int r0 = _reactant_offset[rxn];
+        const unsigned int nr = _reactant_offset[rxn+1] - r0;
+
+        StateType facfwd = Antioch::constant_clone(T,1);
+        for(unsigned int ro = 0; ro < nr; ro++)
+          {
+            val[ro]  = concentration_power(molar_densities[_reactant_ids[r0 + ro]],
+                                           _reactant_order_types[r0 + ro], _reactant_orders[r0 + ro]);
+            dval[ro] = _reactant_stoichiometry[r0 + ro] *
+                       concentration_power_minus_one(molar_densities[_reactant_ids[r0 + ro]],
+                                                     _reactant_order_types[r0 + ro], _reactant_orders[r0 + ro]);
+            facfwd *= val[ro];
+          }
+
+        dnet_rate_v[rxn] = facfwd * dkfwd_dT[rxn] * v_T;
+
+        for(unsigned int ro = 0; ro < nr; ro++)
+          {
+            StateType dRfwd_dX = kfwd[rxn] * dval[ro];
+            for(unsigned int ri = 0; ri < nr; ri++)
+              {
+                if(ri != ro)
+                  {
+                    dRfwd_dX *= val[ri];
+                  }
+              }
+            dnet_rate_v[rxn] += dRfwd_dX * v_X[_reactant_ids[r0 + ro]];
+          }
+
+        if(_collision[rxn])
+          {
+            dnet_rate_v[rxn] += facfwd * dkfwd_dM[rxn] * v_M[_efficiency_set[rxn]];
+          }
+
+        net_reaction_rates[rxn] = facfwd * kfwd[rxn];
+      }
+
+    // backward rates of progress
+    for(unsigned int i = 0; i < _reversible.size(); i++)
+      {
+        const unsigned int rxn = _reversible[i];
+        const unsigned int p0 = _product_offset[rxn];
+        const unsigned int np = _product_offset[rxn+1] - p0;
+
+        const StateType& keq     = workspace.keq[rxn];
+        const StateType& dkeq_dT = workspace.dkeq_dT[rxn];
+
+        const StateType kbkwd = kfwd[rxn]/keq;
+        const StateType dkbkwd_dT = (dkfwd_dT[rxn] - kbkwd*dkeq_dT)/keq;
+
+        StateType facbkwd = Antioch::constant_clone(T,1);
+        for(unsigned int po = 0; po < np; po++)
+          {
+            val[po]  = concentration_power(molar_densities[_product_ids[p0 + po]],
+                                           _product_order_types[p0 + po], _product_orders[p0 + po]);
+            dval[po] = _product_stoichiometry[p0 + po] *
+                       concentration_power_minus_one(molar_densities[_product_ids[p0 + po]],
+                                                     _product_order_types[p0 + po], _product_orders[p0 + po]);
+            facbkwd *= val[po];
+          }
+
+        // If we have an equilibrium constant of zero, our reverse
+        // reaction rate should be infinity, not NaN, and
+        // if our rate is maxed out then our derivatives are zero.
+        typename Antioch::rebind<StateType,bool>::type is_nonzero = (keq != Antioch::zero_clone(keq));
+
+        StateType dRbkwd_v = facbkwd * dkbkwd_dT * v_T;
+        for(unsigned int po = 0; po < np; po++)
+          {
+            StateType dRbkwd_dX = kbkwd * dval[po];
+            for(unsigned int pi = 0; pi < np; pi++)
+              {
+                if(pi != po)
+                  {
+                    dRbkwd_dX *= val[pi];
+                  }
+              }
+            dRbkwd_v += dRbkwd_dX * v_X[_product_ids[p0 + po]];
+          }
+
+        if(_collision[rxn])
+          {
+            dRbkwd_v += facbkwd * dkfwd_dM[rxn] / keq * v_M[_efficiency_set[rxn]];
+          }
+
+        const StateType Rbkwd = facbkwd * kbkwd;
+        net_reaction_rates[rxn] -= Antioch::if_else(is_nonzero, Rbkwd,
+                                                    Antioch::constant_clone(keq, _max_rate[rxn]));
+        dnet_rate_v[rxn]        -= Antioch::if_else(is_nonzero, dRbkwd_v,
+                                                    Antioch::zero_clone(keq));
+      }
+
+    // everything else
+    for(unsigned int i = 0; i < _generic.size(); i++)
+      {
+        const unsigned int rxn = _generic[i];
+        StateType dnet_rate_dT = Antioch::zero_clone(T);
+        _reaction_set.reaction(rxn).compute_rate_of_progress_and_derivatives( molar_densities, this->chemical_mixture(),
+                                                                              conditions, P0_RT, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                                              net_reaction_rates[rxn],
+                                                                              dnet_rate_dT,
+                                                                              workspace.dnet_rate_dX_s[rxn],
+                                                                              workspace.dkfwd_dX_s );
+        dnet_rate_v[rxn] = dnet_rate_dT * v_T;
+        for(unsigned int s = 0; s < this->n_species(); s++)
+          {
+            dnet_rate_v[rxn] += workspace.dnet_rate_dX_s[rxn][s] * v_X[s];
+          }
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType>
+  inline
+  void CompiledReactionSet<CoeffType>::compute_reaction_rates_vjp( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                   const VectorStateType& molar_densities,
+                                                                   const VectorStateType& h_RT_minus_s_R,
+                                                                   const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                   const VectorReactionsType& w,
+                                                                   VectorReactionsType& net_reaction_rates,
+                                                                   StateType& w_dT,
+                                                                   VectorStateType& w_dX,
+                                                                   KineticsWorkspace<StateType,VectorStateType>& workspace ) const
+  {
+    antioch_assert_equal_to( net_reaction_rates.size(), this->n_reactions() );
+    antioch_assert_equal_to( w.size(), this->n_reactions() );
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( w_dX.size(), this->n_species() );
+    antioch_assert_greater_equal( workspace.collision_direction.size(), this->n_efficiency_sets() );
+
+    const StateType& T = conditions.T();
+
+    // useful constants
+    const StateType P0_RT = _P0_R/T; // used to transform equilibrium constant from pressure units
+
+    std::vector<StateType>& kfwd       = workspace.kfwd;
+    std::vector<StateType>& dkfwd_dT   = workspace.dkfwd_dT;
+    std::vector<StateType>& dkfwd_dM   = workspace.dkfwd_dM;
+    std::vector<StateType>& val        = workspace.val;
+    std::vector<StateType>& dval       = workspace.dval;
+
+    this->prepare_derivatives(conditions,molar_densities,h_RT_minus_s_R,dh_RT_minus_s_R_dT,workspace);
+
+    // weighted [M] derivatives, gathered by set of efficiencies
+    std::vector<StateType>& w_dM = workspace.collision_direction;
+    for(unsigned int set = 0; set < this->n_efficiency_sets(); set++)
+      {
+        w_dM[set] = Antioch::zero_clone(T);
+      }
+
+    w_dT = Antioch::zero_clone(T);
+    Antioch::set_zero(w_dX);
+
+    // forward rates of progress
+    for(unsigned int i = 0; i < _compiled.size(); i++)
+      {
+        const unsigned int rxn = _compiled[i];
+        const unsigned int r0 = _reactant_offset[rxn];
+        const unsigned int nr = _reactant_offset[rxn+1] - r0;
+
+        StateType facfwd = Antioch::constant_clone(T,1);
+        for(unsigned int ro = 0; ro < nr; ro++)
+          {
+            val[ro]  = concentration_power(molar_densities[_reactant_ids[r0 + ro]],
+                                           _reactant_order_types[r0 + ro], _reactant_orders[r0 + ro]);
+            dval[ro] = _reactant_stoichiometry[r0 + ro] *
+                       concentration_power_minus_one(molar_densities[_reactant_ids[r0 + ro]],
+                                                     _reactant_order_types[r0 + ro], _reactant_orders[r0 + ro]);
+            facfwd *= val[ro];
+          }
+
+        for(unsigned int ro = 0; ro < nr; ro++)
+          {
+            StateType dRfwd_dX = w[rxn] * kfwd[rxn] * dval[ro];
+            for(unsigned int ri = 0; ri < nr; ri++)
+              {
+                if(ri != ro)
+                  {
+                    dRfwd_dX *= val[ri];
+                  }
+              }
+            w_dX[_reactant_ids[r0 + ro]] += dRfwd_dX;
+          }
+
+        if(_collision[rxn])
+          {
+            w_dM[_efficiency_set[rxn]] += w[rxn] * facfwd * dkfwd_dM[rxn];
+          }
+
+        net_reaction_rates[rxn] = facfwd * kfwd[rxn];
+        w_dT += w[rxn] * facfwd * dkfwd_dT[rxn];
+      }
+
+    // backward rates of progress
+    for(unsigned int i = 0; i < _reversible.size(); i++)
+      {
+        const unsigned int rxn = _reversible[i];
+        const unsigned int p0 = _product_offset[rxn];
+        const unsigned int np = _product_offset[rxn+1] - p0;
+
+        const StateType& keq     = workspace.keq[rxn];
+        const StateType& dkeq_dT = workspace.dkeq_dT[rxn];
+
+        const StateType kbkwd = kfwd[rxn]/keq;
+        const StateType dkbkwd_dT = (dkfwd_dT[rxn] - kbkwd*dkeq_dT)/keq;
+
+        StateType facbkwd = Antioch::constant_clone(T,1);
+        for(unsigned int po = 0; po < np; po++)
+          {
+            val[po]  = concentration_power(molar_densities[_product_ids[p0 + po]],
+                                           _product_order_types[p0 + po], _product_orders[p0 + po]);
+            dval[po] = _product_stoichiometry[p0 + po] *
+                       concentration_power_minus_one(molar_densities[_product_ids[p0 + po]],
+                                                     _product_order_types[p0 + po], _product_orders[p0 + po]);
+            facbkwd *= val[po];
+          }
+
+        // If we have an equilibrium constant of zero, our reverse
+        // reaction rate should be infinity, not NaN, and
+        // if our rate is maxed out then our derivatives are zero.
+        typename Antioch::rebind<StateType,bool>::type is_nonzero = (keq != Antioch::zero_clone(keq));
+        const StateType w_bkwd = Antioch::if_else(is_nonzero, Antioch::constant_clone(keq,1) * w[rxn],
+                                                  Antioch::zero_clone(keq));
+
+        for(unsigned int po = 0; po < np; po++)
+          {
+            StateType dRbkwd_dX = w_bkwd * kbkwd * dval[po];
+            for(unsigned int pi = 0; pi < np; pi++)
+              {
+                if(pi != po)
+                  {
+                    dRbkwd_dX *= val[pi];
+                  }
+              }
+            w_dX[_product_ids[p0 + po]] -= dRbkwd_dX;
+          }
+
+        if(_collision[rxn])
+          {
+            w_dM[_efficiency_set[rxn]] -= w_bkwd * facbkwd * dkfwd_dM[rxn] / keq;
+          }
+
+        const StateType Rbkwd = facbkwd * kbkwd;
+        net_reaction_rates[rxn] -= Antioch::if_else(is_nonzero, Rbkwd,
+                                                    Antioch::constant_clone(keq, _max_rate[rxn]));
+        w_dT -= w_bkwd * facbkwd * dkbkwd_dT;
+      }
+
+    // everything else
+    for(unsigned int i = 0; i < _generic.size(); i++)
+      {
+        const unsigned int rxn = _generic[i];
+        StateType dnet_rate_dT = Antioch::zero_clone(T);
+        _reaction_set.reaction(rxn).compute_rate_of_progress_and_derivatives( molar_densities, this->chemical_mixture(),
+                                                                              conditions, P0_RT, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                                              net_reaction_rates[rxn],
+                                                                              dnet_rate_dT,
+                                                                              workspace.dnet_rate_dX_s[rxn],
+                                                                              workspace.dkfwd_dX_s );
+        w_dT += w[rxn] * dnet_rate_dT;
+        for(unsigned int s = 0; s < this->n_species(); s++)
+          {
+            w_dX[s] += w[rxn] * workspace.dnet_rate_dX_s[rxn][s];
+          }
+      }
+
+    // [M] derivatives: every species, then the efficiency overrides
+    StateType w_dM_total = Antioch::zero_clone(T);
+    for(unsigned int set = 0; set < this->n_efficiency_sets(); set++)
+      {
+        w_dM_total += w_dM[set];
+        for(unsigned int i = _efficiency_offset[set]; i < _efficiency_offset[set+1]; i++)
+          {
+            w_dX[_efficiency_ids[i]] += _efficiency_excess[i] * w_dM[set];
+          }
+      }
+    for(unsigned int s = 0; s < this->n_species(); s++)
+      {
+        w_dX[s] += w_dM_total;
+      }
+
+    return;
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_COMPILED_REACTION_SET_H
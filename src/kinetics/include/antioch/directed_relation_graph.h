@@ -0,0 +1,451 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+
+#ifndef ANTIOCH_DIRECTED_RELATION_GRAPH_H
+#define ANTIOCH_DIRECTED_RELATION_GRAPH_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/reaction_set.h"
+#include "antioch/kinetics_conditions.h"
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Antioch
+{
+  namespace ReductionMethod
+  {
+    //! Interaction coefficients of the directed relation graph
+    /*!
+     * DRG: \f$ r_{AB} = \frac{\sum_i |\nu_{A,i} \omega_i| \delta_{B,i}}{\sum_i |\nu_{A,i} \omega_i|} \f$,
+     * a species is kept when a path of coefficients above the threshold
+     * joins it to a target.
+     *
+     * DRGEP: \f$ r_{AB} = \frac{|\sum_i \nu_{A,i} \omega_i \delta_{B,i}|}{\max(P_A,C_A)} \f$,
+     * with \f$P_A\f$ and \f$C_A\f$ the production and consumption rates of
+     * \f$A\f$, a species is kept when the largest product of the coefficients
+     * along a path from a target is above the threshold.
+     */
+    enum ReductionMethod { DRG = 0,
+                           DRGEP };
+
+  } // end namespace ReductionMethod
+
+  //! Directed relation graph reduction of a ReactionSet
+  /*!\class DirectedRelationGraph
+   *
+   * The species interaction coefficients are computed from the net rates
+   * of progress of the reaction set at the sample states given to
+   * add_sample(), keeping their maximum over the samples. A species
+   * \f$B\f$ takes part in the reaction \f$i\f$ (\f$\delta_{B,i} = 1\f$) when it
+   * is a reactant or a product, third bodies do not count.
+   *
+   * retained_species() gives the species of the skeletal mechanism. As the
+   * parsers skip the reactions involving species missing from the
+   * ChemicalMixture, the reduced ChemicalMixture and ReactionSet are built
+   * by reading the detailed mechanism again with these species only. Inert
+   * species that matter as third bodies (diluents) should be targets.
+   *
+   * Scalar states only.
+   */
+  template<typename CoeffType=double>
+  class DirectedRelationGraph
+  {
+  public:
+
+    //! Constructor, builds the graph of the reaction set, without samples.
+    DirectedRelationGraph( const ReactionSet<CoeffType>& reaction_set );
+
+    ~DirectedRelationGraph();
+
+    //! Accumulate the interaction coefficients of this state
+    template <typename StateType, typename VectorStateType>
+    void add_sample( const KineticsConditions<StateType,VectorStateType>& conditions,
+                     const VectorStateType& molar_densities,
+                     const VectorStateType& h_RT_minus_s_R );
+
+    //! Forget all the samples
+    void clear_samples();
+
+    unsigned int n_samples() const;
+
+    //! Largest coefficient \f$r_{AB}\f$ over the samples, 0 if \p A and \p B do not interact
+    CoeffType interaction_coefficient( const unsigned int A, const unsigned int B,
+                                       const ReductionMethod::ReductionMethod method ) const;
+
+    //! Species kept from \p targets, by index
+    void retained_species( const std::vector<unsigned int>& targets,
+                           const CoeffType threshold,
+                           const ReductionMethod::ReductionMethod method,
+                           std::vector<bool>& retained ) const;
+
+    //! Species kept from \p targets, by name, in the order of the mixture
+    void retained_species( const std::vector<std::string>& targets,
+                           const CoeffType threshold,
+                           const ReductionMethod::ReductionMethod method,
+                           std::vector<std::string>& species ) const;
+
+  protected:
+
+    const ReactionSet<CoeffType>& _reaction_set;
+
+    unsigned int _n_samples;
+
+    //! per reaction: participating species, each once, and their net coefficients
+    std::vector<unsigned int> _participant_offsets;
+    std::vector<unsigned int> _participants;
+    std::vector<CoeffType>    _nu;
+
+    //! CSR: species B interacting with A are in _neighbors[_neighbor_offsets[A].._neighbor_offsets[A+1])
+    std::vector<unsigned int> _neighbor_offsets;
+    std::vector<unsigned int> _neighbors;
+
+    //! per reaction, per ordered pair of distinct participants (A,B): edge of A -> B
+    std::vector<unsigned int> _pair_offsets;
+    std::vector<unsigned int> _pair_edges;
+
+    //! per edge: largest coefficients over the samples
+    std::vector<CoeffType> _drg;
+    std::vector<CoeffType> _drgep;
+
+  private:
+
+    DirectedRelationGraph();
+
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType>
+  inline
+  DirectedRelationGraph<CoeffType>::DirectedRelationGraph( const ReactionSet<CoeffType>& reaction_set )
+    : _reaction_set(reaction_set),
+      _n_samples(0)
+  {
+    const unsigned int n_species = reaction_set.n_species();
+    const unsigned int n_reactions = reaction_set.n_reactions();
+
+    // participants, merging the species appearing several times
+    _participant_offsets.assign(1,0);
+    std::vector<int> net(n_species,0);
+    std::vector<bool> seen(n_species,false);
+
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      {
+        const Reaction<CoeffType>& reaction = reaction_set.reaction(rxn);
+        const unsigned int p0 = _participants.size();
+
+        for(unsigned int r = 0; r < reaction.n_reactants(); r++)
+          {
+            const unsigned int s = reaction.reactant_id(r);
+            if(!seen[s])
+              {
+                seen[s] = true;
+                _participants.push_back(s);
+              }
+            net[s] -= static_cast<int>(reaction.reactant_stoichiometric_coefficient(r));
+          }
+        for(unsigned int p = 0; p < reaction.n_products(); p++)
+          {
+            const unsigned int s = reaction.product_id(p);
+            if(!seen[s])
+              {
+                seen[s] = true;
+                _participants.push_back(s);
+              }
+            net[s] += static_cast<int>(reaction.product_stoichiometric_coefficient(p));
+          }
+
+        for(unsigned int i = p0; i < _participants.size(); i++)
+          {
+            _nu.push_back(net[_participants[i]]);
+            net[_participants[i]] = 0;
+            seen[_participants[i]] = false;
+          }
+        _participant_offsets.push_back(_participants.size());
+      }
+
+    // neighbors of each species, sorted
+    std::vector<std::vector<unsigned int> > neighbors(n_species);
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      for(unsigned int a = _participant_offsets[rxn]; a < _participant_offsets[rxn+1]; a++)
+        for(unsigned int b = _participant_offsets[rxn]; b < _participant_offsets[rxn+1]; b++)
+          if(a != b)
+            neighbors[_participants[a]].push_back(_participants[b]);
+
+    _neighbor_offsets.assign(1,0);
+    for(unsigned int s = 0; s < n_species; s++)
+      {
+        std::sort(neighbors[s].begin(), neighbors[s].end());
+        neighbors[s].erase(std::unique(neighbors[s].begin(), neighbors[s].end()), neighbors[s].end());
+        _neighbors.insert(_neighbors.end(), neighbors[s].begin(), neighbors[s].end());
+        _neighbor_offsets.push_back(_neighbors.size());
+      }
+
+    // edges of the pairs of each reaction
+    _pair_offsets.assign(1,0);
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      {
+        for(unsigned int a = _participant_offsets[rxn]; a < _participant_offsets[rxn+1]; a++)
+          for(unsigned int b = _participant_offsets[rxn]; b < _participant_offsets[rxn+1]; b++)
+            if(a != b)
+              {
+                const unsigned int A = _participants[a];
+                const std::vector<unsigned int>::const_iterator first = _neighbors.begin() + _neighbor_offsets[A];
+                const std::vector<unsigned int>::const_iterator last  = _neighbors.begin() + _neighbor_offsets[A+1];
+                _pair_edges.push_back(std::lower_bound(first, last, _participants[b]) - _neighbors.begin());
+              }
+        _pair_offsets.push_back(_pair_edges.size());
+      }
+
+    _drg.assign(_neighbors.size(),0);
+    _drgep.assign(_neighbors.size(),0);
+
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  DirectedRelationGraph<CoeffType>::~DirectedRelationGraph()
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  void DirectedRelationGraph<CoeffType>::clear_samples()
+  {
+    _n_samples = 0;
+    std::fill(_drg.begin(), _drg.end(), 0);
+    std::fill(_drgep.begin(), _drgep.end(), 0);
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int DirectedRelationGraph<CoeffType>::n_samples() const
+  {
+    return _n_samples;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void DirectedRelationGraph<CoeffType>::add_sample( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                     const VectorStateType& molar_densities,
+                                                     const VectorStateType& h_RT_minus_s_R )
+  {
+    using std::abs;
+    using std::max;
+
+    const unsigned int n_species = _reaction_set.n_species();
+    const unsigned int n_reactions = _reaction_set.n_reactions();
+
+    std::vector<StateType> rates(n_reactions);
+    _reaction_set.compute_reaction_rates( conditions, molar_densities, h_RT_minus_s_R, rates );
+
+    // per species: sum_i |nu_A,i w_i|, production and consumption;
+    // per edge: sum_i |nu_A,i w_i| and sum_i nu_A,i w_i over the reactions of B
+    std::vector<StateType> total(n_species,0), production(n_species,0), consumption(n_species,0);
+    std::vector<StateType> edge_abs(_neighbors.size(),0), edge_net(_neighbors.size(),0);
+
+    for(unsigned int rxn = 0; rxn < n_reactions; rxn++)
+      {
+        unsigned int e = _pair_offsets[rxn];
+        for(unsigned int a = _participant_offsets[rxn]; a < _participant_offsets[rxn+1]; a++)
+          {
+            const unsigned int A = _participants[a];
+            const StateType rate = _nu[a] * rates[rxn];
+
+            total[A] += abs(rate);
+            if(rate > 0)
+              production[A] += rate;
+            else
+              consumption[A] -= rate;
+
+            for(unsigned int b = _participant_offsets[rxn]; b < _participant_offsets[rxn+1]; b++)
+              {
+                if(a == b)
+                  continue;
+                edge_abs[_pair_edges[e]] += abs(rate);
+                edge_net[_pair_edges[e]] += rate;
+                e++;
+              }
+          }
+      }
+
+    for(unsigned int A = 0; A < n_species; A++)
+      {
+        const StateType drgep_scale = max(production[A], consumption[A]);
+        for(unsigned int e = _neighbor_offsets[A]; e < _neighbor_offsets[A+1]; e++)
+          {
+            if(total[A] > 0)
+              _drg[e] = max(_drg[e], static_cast<CoeffType>(edge_abs[e] / total[A]));
+            if(drgep_scale > 0)
+              _drgep[e] = max(_drgep[e], static_cast<CoeffType>(abs(edge_net[e]) / drgep_scale));
+          }
+      }
+
+    _n_samples++;
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType DirectedRelationGraph<CoeffType>::interaction_coefficient( const unsigned int A, const unsigned int B,
+                                                                       const ReductionMethod::ReductionMethod method ) const
+  {
+    antioch_assert_less( A, _reaction_set.n_species() );
+    antioch_assert_less( B, _reaction_set.n_species() );
+
+    const std::vector<unsigned int>::const_iterator first = _neighbors.begin() + _neighbor_offsets[A];
+    const std::vector<unsigned int>::const_iterator last  = _neighbors.begin() + _neighbor_offsets[A+1];
+    const std::vector<unsigned int>::const_iterator it = std::lower_bound(first, last, B);
+
+    if(it == last || *it != B)
+      return 0;
+
+    return (method == ReductionMethod::DRG) ? _drg[it - _neighbors.begin()] : _drgep[it - _neighbors.begin()];
+  }
+
+  template<typename CoeffType>
+  inline
+  void DirectedRelationGraph<CoeffType>::retained_species( const std::vector<unsigned int>& targets,
+                                                           const CoeffType threshold,
+                                                           const ReductionMethod::ReductionMethod method,
+                                                           std::vector<bool>& retained ) const
+  {
+    const unsigned int n_species = _reaction_set.n_species();
+
+    if( !_n_samples )
+      antioch_error_msg("No sample state given to the directed relation graph");
+
+    switch(method)
+      {
+      case(ReductionMethod::DRG):
+        {
+          // everything reachable through the edges above the threshold
+          retained.assign(n_species,false);
+          std::vector<unsigned int> stack;
+          for(unsigned int t = 0; t < targets.size(); t++)
+            {
+              antioch_assert_less( targets[t], n_species );
+              if(!retained[targets[t]])
+                {
+                  retained[targets[t]] = true;
+                  stack.push_back(targets[t]);
+                }
+            }
+
+          while(!stack.empty())
+            {
+              const unsigned int A = stack.back();
+              stack.pop_back();
+              for(unsigned int e = _neighbor_offsets[A]; e < _neighbor_offsets[A+1]; e++)
+                if(_drg[e] >= threshold && !retained[_neighbors[e]])
+                  {
+                    retained[_neighbors[e]] = true;
+                    stack.push_back(_neighbors[e]);
+                  }
+            }
+        }
+        break;
+
+      case(ReductionMethod::DRGEP):
+        {
+          // largest path products, Dijkstra-like as the coefficients are at most 1
+          std::vector<CoeffType> R(n_species,0);
+          std::priority_queue<std::pair<CoeffType,unsigned int> > queue;
+          for(unsigned int t = 0; t < targets.size(); t++)
+            {
+              antioch_assert_less( targets[t], n_species );
+              R[targets[t]] = 1;
+              queue.push(std::make_pair(CoeffType(1),targets[t]));
+            }
+
+          while(!queue.empty())
+            {
+              const CoeffType RA = queue.top().first;
+              const unsigned int A = queue.top().second;
+              queue.pop();
+              if(RA < R[A])
+                continue;
+
+              for(unsigned int e = _neighbor_offsets[A]; e < _neighbor_offsets[A+1]; e++)
+                {
+                  const CoeffType RB = RA * _drgep[e];
+                  if(RB > R[_neighbors[e]])
+                    {
+                      R[_neighbors[e]] = RB;
+                      queue.push(std::make_pair(RB,_neighbors[e]));
+                    }
+                }
+            }
+
+          retained.resize(n_species);
+          for(unsigned int s = 0; s < n_species; s++)
+            retained[s] = (R[s] > 0 && R[s] >= threshold);
+        }
+        break;
+
+      default:
+        antioch_error_msg("Unknown reduction method");
+      }
+  }
+
+  template<typename CoeffType>
+  inline
+  void DirectedRelationGraph<CoeffType>::retained_species( const std::vector<std::string>& targets,
+                                                           const CoeffType threshold,
+                                                           const ReductionMethod::ReductionMethod method,
+                                                           std::vector<std::string>& species ) const
+  {
+    const ChemicalMixture<CoeffType>& chem_mixture = _reaction_set.chemical_mixture();
+
+    std::vector<unsigned int> target_ids;
+    for(unsigned int t = 0; t < targets.size(); t++)
+      {
+        if( !chem_mixture.species_name_map().count(targets[t]) )
+          antioch_error_msg("Unknown target species "+targets[t]);
+        target_ids.push_back(chem_mixture.species_name_map().find(targets[t])->second);
+      }
+
+    std::vector<bool> retained;
+    this->retained_species(target_ids, threshold, method, retained);
+
+    species.clear();
+    for(unsigned int s = 0; s < retained.size(); s++)
+      if(retained[s])
+        species.push_back(chem_mixture.species_inverse_name_map().find(s)->second);
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_DIRECTED_RELATION_GRAPH_H
@@ -121,6 +121,15 @@ namespace Antioch
                                                            StateType& dkfwd_dT, 
                                                            VectorStateType& dkfkwd_dX) const;
 
+    //! \f$\frac{\partial \ln k}{\partial \ln k_0}\f$
+    /*! The high pressure rate constant has the complement,
+     *  \f$\frac{\partial \ln k}{\partial \ln k_\infty} = 1 - \frac{\partial \ln k}{\partial \ln k_0}\f$,
+     *  as \f$F\f$ depends on both only through \f$P_r = [M] k_0 / k_\infty\f$.
+     */
+    template <typename StateType, typename VectorStateType>
+    StateType compute_low_pressure_log_sensitivity( const VectorStateType& molar_densities,
+                                                    const KineticsConditions<StateType,VectorStateType>& conditions ) const;
+
 
     //! Return const reference to the falloff object
     const FalloffType &F() const;
@@ -218,8 +227,8 @@ namespace Antioch
     //F
     StateType f = Antioch::zero_clone(M);
     StateType df_dT = Antioch::zero_clone(M);
-    VectorStateType df_dX = Antioch::zero_clone(molar_densities);
-    _F.F_and_derivatives(conditions.T(),M,k0,dk0_dT,kinf,dkinf_dT,f,df_dT,df_dX);
+    StateType df_dM = Antioch::zero_clone(M);
+    _F.F_and_derivatives(conditions.T(),M,k0,dk0_dT,kinf,dkinf_dT,f,df_dT,df_dM);
 
 // k(T,[M]) = k0*[M]/(1 + [M]*k0/kinf) * F = k0 * ([M]^-1 + k0 * kinf^-1)^-1 * F    
     kfwd = k0 / (ant_pow(M,-1) + k0/kinf); //temp variable here for calculations dk_d{T,X}
@@ -233,11 +242,11 @@ namespace Antioch
 
     dkfwd_dX.resize(this->n_species(), kfwd);
 //dkfwd_dX = F * dkfwd_dX + kfwd * dF_dX
-//         = F * kfwd / ([M] +  [M]^2 k0/kinf) + kfwd * dF_dX
-    StateType tmp = f * kfwd / (M + ant_pow(M,2) * k0/kinf);
+//         = F * kfwd / ([M] +  [M]^2 k0/kinf) + kfwd * dF_dM
+    const StateType tmp = f * kfwd / (M + ant_pow(M,2) * k0/kinf) + df_dM * kfwd;
     for(unsigned int ic = 0; ic < this->n_species(); ic++)
       {
-        dkfwd_dX[ic] = tmp + df_dX[ic] * kfwd;
+        dkfwd_dX[ic] = tmp;
       }
 
     kfwd *= f; //finalize
@@ -246,6 +255,28 @@ namespace Antioch
 
     return;
   }
+
+  template<typename CoeffType, typename FalloffType>
+  template<typename StateType, typename VectorStateType>
+  inline
+  StateType FalloffReaction<CoeffType,FalloffType>::compute_low_pressure_log_sensitivity( const VectorStateType& molar_densities,
+                                                                                          const KineticsConditions<StateType,VectorStateType>& conditions ) const
+  {
+    const StateType k0   = (*this->_forward_rate[0])(conditions);
+    const StateType kinf = (*this->_forward_rate[1])(conditions);
+
+    StateType M = Antioch::zero_clone(conditions.T());
+    for(unsigned int i = 0; i < molar_densities.size(); i++)
+    {
+        M += molar_densities[i];
+    }
+
+// d ln k / d ln k0 = 1/(1 + Pr) + d ln F / d ln Pr
+    const StateType Pr = M * k0 / kinf;
+
+    return Antioch::constant_clone(Pr,1) / (Antioch::constant_clone(Pr,1) + Pr)
+         + _F.dlogF_dlogPr(conditions.T(),M,k0,kinf);
+  }
   
 } // namespace Antioch
 
@@ -125,6 +125,15 @@ namespace Antioch
                                                            StateType& dkfwd_dT, 
                                                            VectorStateType& dkfkwd_dX) const;
 
+    //! \f$\frac{\partial \ln k}{\partial \ln k_0}\f$
+    /*! The high pressure rate constant has the complement,
+     *  \f$\frac{\partial \ln k}{\partial \ln k_\infty} = 1 - \frac{\partial \ln k}{\partial \ln k_0}\f$,
+     *  as \f$F\f$ depends on both only through \f$P_r = [M] k_0 / k_\infty\f$.
+     */
+    template <typename StateType, typename VectorStateType>
+    StateType compute_low_pressure_log_sensitivity( const VectorStateType& molar_densities,
+                                                    const KineticsConditions<StateType,VectorStateType>& conditions ) const;
+
 
     //! Return const reference to the falloff object
     const FalloffType &F() const;
@@ -150,8 +159,7 @@ namespace Antioch
      _F(n_species)
      
   {
-    Reaction<CoeffType>::_efficiencies.resize(n_species); 
-    std::fill (Reaction<CoeffType>::_efficiencies.begin(), Reaction<CoeffType>::_efficiencies.end(), 1.);
+    return;
   }
 
 
@@ -186,8 +194,9 @@ namespace Antioch
     StateType M = Antioch::zero_clone(conditions.T());
     for(unsigned int s = 0; s < molar_densities.size(); s++)
     {
-        M += this->efficiency(s) * molar_densities[s];
+        M += molar_densities[s];
     }
+    M = this->efficiency_weighted_concentration(M,molar_densities);
 
     const StateType k0   = (*this->_forward_rate[0])(conditions);
     const StateType kinf = (*this->_forward_rate[1])(conditions);
@@ -220,14 +229,15 @@ namespace Antioch
     StateType M = Antioch::zero_clone(conditions.T());
     for(unsigned int s = 0; s < molar_densities.size(); s++)
     {
-        M += this->efficiency(s) * molar_densities[s];
+        M += molar_densities[s];
     }
+    M = this->efficiency_weighted_concentration(M,molar_densities);
 
     //F
     StateType f = Antioch::zero_clone(conditions.T());
     StateType df_dT = Antioch::zero_clone(conditions.T());
-    VectorStateType df_dX = Antioch::zero_clone(molar_densities);
-    _F.F_and_derivatives(conditions.T(),M,k0,dk0_dT,kinf,dkinf_dT,f,df_dT,df_dX);
+    StateType df_dM = Antioch::zero_clone(M);
+    _F.F_and_derivatives(conditions.T(),M,k0,dk0_dT,kinf,dkinf_dT,f,df_dT,df_dM);
 
 // k(T,[M]) = k0*[M]/(1 + [M]*k0/kinf) * F = k0 * ([M]^-1 + k0 * kinf^-1)^-1 * F    
     kfwd = k0 / (ant_pow(M,-1) + k0/kinf); //temp variable here for calculations dk_d{T,X}
@@ -241,12 +251,16 @@ namespace Antioch
 
     dkfwd_dX.resize(this->n_species(), kfwd);
 
-    StateType tmp = f * kfwd / (M + ant_pow(M,2) * k0/kinf);
+    const StateType tmp = f * kfwd / (M + ant_pow(M,2) * k0/kinf) + df_dM * kfwd;
 //dkfwd_dX = F * dkfwd_dX + kfwd * dF_dX
-//         = F * epsilon_i * kfwd / ([M] +  [M]^2 k0/kinf) + kfwd * dF_dX
+//         = epsilon_i * (F * kfwd / ([M] +  [M]^2 k0/kinf) + kfwd * dF_dM)
     for(unsigned int ic = 0; ic < this->n_species(); ic++)
       {
-        dkfwd_dX[ic] = this->efficiency(ic) * ( tmp + df_dX[ic] * kfwd );
+        dkfwd_dX[ic] = tmp;
+      }
+    for(unsigned int i = 0; i < this->n_efficiency_overrides(); i++)
+      {
+        dkfwd_dX[this->efficiency_override_id(i)] = this->efficiency_override(i) * tmp;
       }
 
     kfwd *= f; //finalize
@@ -255,6 +269,29 @@ namespace Antioch
 
     return;
   }
+
+  template<typename CoeffType, typename FalloffType>
+  template<typename StateType, typename VectorStateType>
+  inline
+  StateType FalloffThreeBodyReaction<CoeffType,FalloffType>::compute_low_pressure_log_sensitivity( const VectorStateType& molar_densities,
+                                                                                                   const KineticsConditions<StateType,VectorStateType>& conditions ) const
+  {
+    const StateType k0   = (*this->_forward_rate[0])(conditions);
+    const StateType kinf = (*this->_forward_rate[1])(conditions);
+
+    StateType M = Antioch::zero_clone(conditions.T());
+    for(unsigned int s = 0; s < molar_densities.size(); s++)
+    {
+        M += molar_densities[s];
+    }
+    M = this->efficiency_weighted_concentration(M,molar_densities);
+
+// d ln k / d ln k0 = 1/(1 + Pr) + d ln F / d ln Pr
+    const StateType Pr = M * k0 / kinf;
+
+    return Antioch::constant_clone(Pr,1) / (Antioch::constant_clone(Pr,1) + Pr)
+         + _F.dlogF_dlogPr(conditions.T(),M,k0,kinf);
+  }
   
 } // namespace Antioch
 
@@ -0,0 +1,903 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+
+#ifndef ANTIOCH_HOMOGENEOUS_REACTOR_H
+#define ANTIOCH_HOMOGENEOUS_REACTOR_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/physical_constants.h"
+#include "antioch/chemical_mixture.h"
+#include "antioch/temp_cache.h"
+#include "antioch/nasa_mixture.h"
+#include "antioch/nasa_evaluator.h"
+#include "antioch/kinetics_evaluator.h"
+#include "antioch/kinetics_workspace.h"
+#include "antioch/kinetics_conditions.h"
+#include "antioch/sparse_lu.h"
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace Antioch
+{
+  namespace ReactorType
+  {
+    //! Constraint of a HomogeneousReactor
+    enum ReactorType { CONSTANT_VOLUME = 0,
+                       CONSTANT_PRESSURE };
+
+  } // end namespace ReactorType
+
+  namespace ReactorLinearSolver
+  {
+    //! Factorization of the iteration matrix of a HomogeneousReactor
+    enum ReactorLinearSolver { DENSE_LU = 0,
+                               SPARSE_LU };
+
+  } // end namespace ReactorLinearSolver
+
+  //! Work counters of a HomogeneousReactor integration
+  struct ReactorStatistics
+  {
+    ReactorStatistics()
+      : n_steps(0), n_rejected(0), n_rhs(0), n_jacobians(0), n_decompositions(0)
+    {}
+
+    //! accepted and rejected steps
+    unsigned int n_steps;
+    unsigned int n_rejected;
+
+    //! right hand side (mole sources) and Jacobian evaluations
+    unsigned int n_rhs;
+    unsigned int n_jacobians;
+
+    //! LU factorizations of the iteration matrix
+    unsigned int n_decompositions;
+  };
+
+  //! Adiabatic, homogeneous, closed 0-D reactor
+  /*!\class HomogeneousReactor
+   *
+   * The state is \f$y = (T, n_1, \ldots, n_{N_s})\f$, \f$n_s = c_s/\rho\f$ being
+   * the moles of \f$s\f$ per unit mass, with
+   * \f[ \frac{dn_s}{dt} = \frac{\dot{\omega}_s}{\rho}, \qquad
+   *     \frac{dT}{dt} = -\frac{\sum_s e_s \dot{\omega}_s}{\sum_s c_s q_s} \f]
+   * where \f$(e,q) = (u,c_v)\f$ (molar) at constant volume, \f$\rho\f$ being
+   * fixed, and \f$(e,q) = (h,c_p)\f$ at constant pressure, \f$\rho = P/(RT\sum_s n_s)\f$.
+   *
+   * The Jacobian is analytic: the mole sources derivatives of
+   * KineticsEvaluator::compute_mole_sources_and_derivs() composed with the
+   * NASA heat capacities and enthalpies and their temperature derivatives.
+   * It is integrated by the L-stable Rosenbrock method RODAS3 (order 3,
+   * embedded order 2) with step size control on the weighted RMS norm of
+   * the local error.
+   *
+   * The iteration matrix is factorized by a dense LU with partial pivoting
+   * by default. With the SPARSE_LU solver, a SparseLU analyzed once for the
+   * pattern of the Jacobian (the species pattern of the KineticsEvaluator
+   * bordered by a dense temperature row and column) is refactorized instead.
+   * At constant pressure the density couples all the species and the
+   * pattern is dense, so the sparse solver only pays off at constant volume.
+   *
+   * All the work arrays are allocated at construction and the reactor owns
+   * its KineticsWorkspace: one reactor per thread, sharing the evaluator
+   * and thermodynamics. Scalar states only.
+   */
+  template<typename CoeffType=double, typename NASAFit=NASA7CurveFit<CoeffType> >
+  class HomogeneousReactor
+  {
+  public:
+
+    HomogeneousReactor( const KineticsEvaluator<CoeffType>& kinetics,
+                        const NASAThermoMixture<CoeffType,NASAFit>& thermo_mixture,
+                        const ReactorType::ReactorType type );
+
+    ~HomogeneousReactor();
+
+    ReactorType::ReactorType type() const;
+
+    //! Relative and absolute tolerances, on \f$T\f$ and the \f$n_s\f$ [mol/kg]
+    void set_tolerances( const CoeffType rtol, const CoeffType atol );
+
+    //! Most steps of one advance(), 100000 by default
+    void set_max_steps( const unsigned int max_steps );
+
+    //! First step size of the next advance(); 0 (default) starts at 1e-3 times the interval,
+    //  later calls start from the last accepted step size
+    void set_initial_step( const CoeffType h );
+
+    //! Step size the next advance() starts from
+    CoeffType step_size() const;
+
+    //! Factorization of the iteration matrix, DENSE_LU by default
+    void set_linear_solver( const ReactorLinearSolver::ReactorLinearSolver linear_solver );
+
+    ReactorLinearSolver::ReactorLinearSolver linear_solver() const;
+
+    //! Size of the state: n_species + 1
+    unsigned int n_states() const;
+
+    //! Sets the state, and fixes the density or pressure, from \p T and the molar densities
+    template <typename VectorStateType>
+    void set_state( const CoeffType T, const VectorStateType& molar_densities );
+
+    //! Temperature and molar densities of the current state
+    template <typename VectorStateType>
+    void get_state( CoeffType& T, VectorStateType& molar_densities ) const;
+
+    //! Current state, \f$(T, n_1, \ldots, n_{N_s})\f$
+    const std::vector<CoeffType>& state() const;
+
+    //! Integrates the current state over \p dt, false if the step size control failed
+    bool advance( const CoeffType dt );
+
+    //! set_state(), advance() and get_state()
+    template <typename VectorStateType>
+    bool integrate( CoeffType& T, VectorStateType& molar_densities, const CoeffType dt );
+
+    //! Counters since the last set_state()
+    const ReactorStatistics& statistics() const;
+
+    //! Right hand side at \p y, with the density or pressure of set_state()
+    void compute_rhs( const std::vector<CoeffType>& y, std::vector<CoeffType>& dydt );
+
+    //! Right hand side and row major Jacobian at \p y
+    void compute_rhs_and_jacobian( const std::vector<CoeffType>& y,
+                                   std::vector<CoeffType>& dydt,
+                                   std::vector<CoeffType>& jacobian );
+
+  protected:
+
+    //! molar densities and density of \p y
+    void compute_molar_densities( const std::vector<CoeffType>& y );
+
+    //! CSR pattern of the Jacobian, rows of the bordered species pattern
+    static std::vector<unsigned int> sparse_offsets( const KineticsEvaluator<CoeffType>& kinetics,
+                                                     const ReactorType::ReactorType type );
+
+    //! CSR pattern of the Jacobian, columns of the bordered species pattern
+    static std::vector<unsigned int> sparse_columns( const KineticsEvaluator<CoeffType>& kinetics,
+                                                     const ReactorType::ReactorType type );
+
+    //! LU factorization of _matrix, false if singular
+    bool factorize();
+
+    //! solves in place with the factorization of _matrix
+    void solve( std::vector<CoeffType>& x );
+
+    //! weighted RMS norm of \p err
+    CoeffType error_norm( const std::vector<CoeffType>& y,
+                          const std::vector<CoeffType>& y_new,
+                          const std::vector<CoeffType>& err ) const;
+
+    const KineticsEvaluator<CoeffType>& _kinetics;
+
+    const NASAThermoMixture<CoeffType,NASAFit>& _thermo_mixture;
+
+    const NASAEvaluator<CoeffType,NASAFit> _thermo;
+
+    const ChemicalMixture<CoeffType>& _chem_mixture;
+
+    const ReactorType::ReactorType _type;
+
+    const unsigned int _n_species;
+
+    CoeffType _rtol;
+    CoeffType _atol;
+    unsigned int _max_steps;
+    CoeffType _h;
+    ReactorLinearSolver::ReactorLinearSolver _linear_solver;
+
+    //! fixed density (constant volume) or pressure (constant pressure)
+    CoeffType _rho;
+    CoeffType _P;
+
+    std::vector<CoeffType> _y;
+
+    ReactorStatistics _statistics;
+
+    KineticsWorkspace<CoeffType> _workspace;
+
+    // kinetics and thermodynamics scratch
+    CoeffType _T;
+    CoeffType _rho_y;
+    std::vector<CoeffType> _molar_densities;
+    std::vector<CoeffType> _h_RT_minus_s_R;
+    std::vector<CoeffType> _dh_RT_minus_s_R_dT;
+    std::vector<CoeffType> _mole_sources;
+    std::vector<CoeffType> _dmole_dT;
+    std::vector<std::vector<CoeffType> > _dmole_dX_s;
+    std::vector<CoeffType> _e;
+    std::vector<CoeffType> _q;
+    std::vector<CoeffType> _domega_dT;
+
+    // integrator scratch
+    std::vector<CoeffType> _jacobian;
+    std::vector<CoeffType> _matrix;
+    std::vector<unsigned int> _pivots;
+    std::vector<unsigned int> _sparse_offsets;
+    std::vector<unsigned int> _sparse_columns;
+    std::vector<CoeffType> _sparse_values;
+    SparseLU<CoeffType> _sparse_lu;
+    std::vector<CoeffType> _f;
+    std::vector<CoeffType> _y_stage;
+    std::vector<CoeffType> _y_new;
+    std::vector<CoeffType> _k1, _k2, _k3, _k4;
+
+  private:
+
+    HomogeneousReactor();
+
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType, typename NASAFit>
+  inline
+  HomogeneousReactor<CoeffType,NASAFit>::HomogeneousReactor( const KineticsEvaluator<CoeffType>& kinetics,
+                                                             const NASAThermoMixture<CoeffType,NASAFit>& thermo_mixture,
+                                                             const ReactorType::ReactorType type )
+    : _kinetics(kinetics),
+      _thermo_mixture(thermo_mixture),
+      _thermo(thermo_mixture),
+      _chem_mixture(thermo_mixture.chemical_mixture()),
+      _type(type),
+      _n_species(kinetics.n_species()),
+      _rtol(1e-6),
+      _atol(1e-12),
+      _max_steps(100000),
+      _h(0),
+      _linear_solver(ReactorLinearSolver::DENSE_LU),
+      _rho(0),
+      _P(0),
+      _y(_n_species + 1, 0),
+      _workspace(kinetics.reaction_set(), 0),
+      _T(0),
+      _rho_y(0),
+      _molar_densities(_n_species, 0),
+      _h_RT_minus_s_R(_n_species, 0),
+      _dh_RT_minus_s_R_dT(_n_species, 0),
+      _mole_sources(_n_species, 0),
+      _dmole_dT(_n_species, 0),
+      _dmole_dX_s(_n_species, std::vector<CoeffType>(_n_species, 0)),
+      _e(_n_species, 0),
+      _q(_n_species, 0),
+      _domega_dT(_n_species, 0),
+      _jacobian((_n_species + 1)*(_n_species + 1), 0),
+      _matrix((_n_species + 1)*(_n_species + 1), 0),
+      _pivots(_n_species + 1, 0),
+      _sparse_offsets(sparse_offsets(kinetics, type)),
+      _sparse_columns(sparse_columns(kinetics, type)),
+      _sparse_values(_sparse_columns.size(), 0),
+      _sparse_lu(_n_species + 1, _sparse_offsets, _sparse_columns),
+      _f(_n_species + 1, 0),
+      _y_stage(_n_species + 1, 0),
+      _y_new(_n_species + 1, 0),
+      _k1(_n_species + 1, 0),
+      _k2(_n_species + 1, 0),
+      _k3(_n_species + 1, 0),
+      _k4(_n_species + 1, 0)
+  {
+    antioch_assert_equal_to( _chem_mixture.n_species(), _n_species );
+    return;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  HomogeneousReactor<CoeffType,NASAFit>::~HomogeneousReactor()
+  {
+    return;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  ReactorType::ReactorType HomogeneousReactor<CoeffType,NASAFit>::type() const
+  {
+    return _type;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::set_tolerances( const CoeffType rtol, const CoeffType atol )
+  {
+    antioch_assert_greater( rtol, CoeffType(0) );
+    antioch_assert_greater( atol, CoeffType(0) );
+    _rtol = rtol;
+    _atol = atol;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::set_max_steps( const unsigned int max_steps )
+  {
+    _max_steps = max_steps;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::set_initial_step( const CoeffType h )
+  {
+    _h = h;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  CoeffType HomogeneousReactor<CoeffType,NASAFit>::step_size() const
+  {
+    return _h;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::set_linear_solver( const ReactorLinearSolver::ReactorLinearSolver linear_solver )
+  {
+    _linear_solver = linear_solver;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  ReactorLinearSolver::ReactorLinearSolver HomogeneousReactor<CoeffType,NASAFit>::linear_solver() const
+  {
+    return _linear_solver;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  unsigned int HomogeneousReactor<CoeffType,NASAFit>::n_states() const
+  {
+    return _n_species + 1;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  const std::vector<CoeffType>& HomogeneousReactor<CoeffType,NASAFit>::state() const
+  {
+    return _y;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  const ReactorStatistics& HomogeneousReactor<CoeffType,NASAFit>::statistics() const
+  {
+    return _statistics;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  template<typename VectorStateType>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::set_state( const CoeffType T, const VectorStateType& molar_densities )
+  {
+    antioch_assert_equal_to( molar_densities.size(), _n_species );
+    antioch_assert_greater( T, CoeffType(0) );
+
+    CoeffType rho(0), C(0);
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        rho += molar_densities[s] * _chem_mixture.M(s);
+        C   += molar_densities[s];
+      }
+
+    antioch_assert_greater( rho, CoeffType(0) );
+
+    _rho = rho;
+    _P = C * Constants::R_universal<CoeffType>() * T;
+
+    _y[0] = T;
+    for(unsigned int s = 0; s < _n_species; s++)
+      _y[s+1] = molar_densities[s] / rho;
+
+    _statistics = ReactorStatistics();
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  template<typename VectorStateType>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::get_state( CoeffType& T, VectorStateType& molar_densities ) const
+  {
+    antioch_assert_equal_to( molar_densities.size(), _n_species );
+
+    T = _y[0];
+
+    CoeffType rho = _rho;
+    if( _type == ReactorType::CONSTANT_PRESSURE )
+      {
+        CoeffType N(0);
+        for(unsigned int s = 0; s < _n_species; s++)
+          N += _y[s+1];
+        rho = _P / (Constants::R_universal<CoeffType>() * T * N);
+      }
+
+    for(unsigned int s = 0; s < _n_species; s++)
+      molar_densities[s] = rho * _y[s+1];
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  template<typename VectorStateType>
+  inline
+  bool HomogeneousReactor<CoeffType,NASAFit>::integrate( CoeffType& T, VectorStateType& molar_densities, const CoeffType dt )
+  {
+    this->set_state( T, molar_densities );
+    const bool success = this->advance( dt );
+    this->get_state( T, molar_densities );
+    return success;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::compute_molar_densities( const std::vector<CoeffType>& y )
+  {
+    _T = y[0];
+
+    _rho_y = _rho;
+    if( _type == ReactorType::CONSTANT_PRESSURE )
+      {
+        CoeffType N(0);
+        for(unsigned int s = 0; s < _n_species; s++)
+          N += y[s+1];
+        _rho_y = _P / (Constants::R_universal<CoeffType>() * _T * N);
+      }
+
+    for(unsigned int s = 0; s < _n_species; s++)
+      _molar_densities[s] = _rho_y * y[s+1];
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::compute_rhs( const std::vector<CoeffType>& y, std::vector<CoeffType>& dydt )
+  {
+    antioch_assert_equal_to( y.size(), this->n_states() );
+    antioch_assert_equal_to( dydt.size(), this->n_states() );
+
+    const CoeffType R = Constants::R_universal<CoeffType>();
+
+    this->compute_molar_densities( y );
+
+    const KineticsConditions<CoeffType> conditions( _T );
+    const TempCache<CoeffType> cache( _T );
+
+    _thermo.h_RT_minus_s_R( cache, _h_RT_minus_s_R );
+    _kinetics.compute_mole_sources( conditions, _molar_densities, _h_RT_minus_s_R, _mole_sources, _workspace );
+
+    // -sum_s e_s w_s / sum_s c_s q_s
+    CoeffType S(0), D(0);
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        CoeffType e = R * _T * _thermo.h_over_RT( cache, s );
+        CoeffType q = R * _thermo.cp_over_R( cache, s );
+        if( _type == ReactorType::CONSTANT_VOLUME )
+          {
+            e -= R * _T;
+            q -= R;
+          }
+
+        S += e * _mole_sources[s];
+        D += _molar_densities[s] * q;
+        dydt[s+1] = _mole_sources[s] / _rho_y;
+      }
+
+    dydt[0] = -S / D;
+
+    _statistics.n_rhs++;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::compute_rhs_and_jacobian( const std::vector<CoeffType>& y,
+                                                                        std::vector<CoeffType>& dydt,
+                                                                        std::vector<CoeffType>& jacobian )
+  {
+    antioch_assert_equal_to( y.size(), this->n_states() );
+    antioch_assert_equal_to( dydt.size(), this->n_states() );
+    antioch_assert_equal_to( jacobian.size(), this->n_states() * this->n_states() );
+
+    const CoeffType R = Constants::R_universal<CoeffType>();
+    const unsigned int n = this->n_states();
+    const bool constant_pressure = ( _type == ReactorType::CONSTANT_PRESSURE );
+
+    this->compute_molar_densities( y );
+
+    const KineticsConditions<CoeffType> conditions( _T );
+    const TempCache<CoeffType> cache( _T );
+
+    _thermo.h_RT_minus_s_R( cache, _h_RT_minus_s_R );
+    _thermo.dh_RT_minus_s_R_dT( cache, _dh_RT_minus_s_R_dT );
+    _kinetics.compute_mole_sources_and_derivs( conditions, _molar_densities, _h_RT_minus_s_R, _dh_RT_minus_s_R_dT,
+                                               _mole_sources, _dmole_dT, _dmole_dX_s, _workspace );
+
+    CoeffType N(0);
+    for(unsigned int s = 0; s < _n_species; s++)
+      N += y[s+1];
+
+    // e_s and q_s = de_s/dT, and the temperature terms of the denominator
+    CoeffType S(0), D(0), dS_dT(0), dD_dT(0);
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        _e[s] = R * _T * _thermo.h_over_RT( cache, s );
+        _q[s] = R * _thermo.cp_over_R( cache, s );
+        if( !constant_pressure )
+          {
+            _e[s] -= R * _T;
+            _q[s] -= R;
+          }
+
+        S += _e[s] * _mole_sources[s];
+        D += _molar_densities[s] * _q[s];
+        dD_dT += _molar_densities[s] * R * _thermo_mixture.curve_fit(s).dcp_over_R_dT( cache );
+      }
+
+    // total temperature derivative of the sources: at constant pressure,
+    // dc_j/dT = -c_j/T and dc_j/dn_k = rho (delta_jk - n_j/N)
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        _domega_dT[s] = _dmole_dT[s];
+        if( constant_pressure )
+          {
+            CoeffType Jc(0);
+            for(unsigned int j = 0; j < _n_species; j++)
+              Jc += _dmole_dX_s[s][j] * _molar_densities[j];
+            _domega_dT[s] -= Jc / _T;
+
+            // reuse _dmole_dT to hold sum_j J_sj c_j
+            _dmole_dT[s] = Jc;
+          }
+
+        dS_dT += _q[s] * _mole_sources[s] + _e[s] * _domega_dT[s];
+        if( constant_pressure )
+          dD_dT -= _molar_densities[s] * _q[s] / _T;
+      }
+
+    dydt[0] = -S / D;
+
+    jacobian[0] = -dS_dT / D + S / (D * D) * dD_dT;
+
+    for(unsigned int k = 0; k < _n_species; k++)
+      {
+        // d(omega_s)/dn_k = rho J_sk (- sum_j J_sj c_j / N)
+        CoeffType dS_dn(0);
+        for(unsigned int s = 0; s < _n_species; s++)
+          {
+            CoeffType domega_dn = _rho_y * _dmole_dX_s[s][k];
+            if( constant_pressure )
+              domega_dn -= _dmole_dT[s] / N;
+            dS_dn += _e[s] * domega_dn;
+          }
+
+        CoeffType dD_dn = _rho_y * _q[k];
+        if( constant_pressure )
+          dD_dn -= D / N;
+
+        jacobian[k+1] = -dS_dn / D + S / (D * D) * dD_dn;
+      }
+
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        dydt[s+1] = _mole_sources[s] / _rho_y;
+
+        CoeffType* row = &jacobian[(s+1)*n];
+
+        // 1/rho: d/dT = 1/(rho T), d/dn_k = 1/(rho N) at constant pressure
+        row[0] = _domega_dT[s] / _rho_y;
+        if( constant_pressure )
+          row[0] += dydt[s+1] / _T;
+
+        for(unsigned int k = 0; k < _n_species; k++)
+          {
+            row[k+1] = _dmole_dX_s[s][k];
+            if( constant_pressure )
+              row[k+1] += (dydt[s+1] - _dmole_dT[s] / _rho_y) / N;
+          }
+      }
+
+    _statistics.n_rhs++;
+    _statistics.n_jacobians++;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  std::vector<unsigned int> HomogeneousReactor<CoeffType,NASAFit>::sparse_offsets( const KineticsEvaluator<CoeffType>& kinetics,
+                                                                                   const ReactorType::ReactorType type )
+  {
+    const unsigned int n = kinetics.n_species() + 1;
+    const std::vector<unsigned int>& species_offsets = kinetics.jacobian_pattern().row_offsets();
+
+    // dense temperature row, then the species rows with their temperature column
+    std::vector<unsigned int> offsets(1,0);
+    offsets.push_back(n);
+    for(unsigned int s = 0; s < kinetics.n_species(); s++)
+      {
+        if( type == ReactorType::CONSTANT_PRESSURE )
+          offsets.push_back(offsets.back() + n);
+        else
+          offsets.push_back(offsets.back() + 1 + species_offsets[s+1] - species_offsets[s]);
+      }
+
+    return offsets;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  std::vector<unsigned int> HomogeneousReactor<CoeffType,NASAFit>::sparse_columns( const KineticsEvaluator<CoeffType>& kinetics,
+                                                                                   const ReactorType::ReactorType type )
+  {
+    const unsigned int n = kinetics.n_species() + 1;
+    const std::vector<unsigned int>& species_offsets = kinetics.jacobian_pattern().row_offsets();
+    const std::vector<unsigned int>& species_columns = kinetics.jacobian_pattern().column_indices();
+
+    std::vector<unsigned int> columns;
+    for(unsigned int j = 0; j < n; j++)
+      columns.push_back(j);
+
+    for(unsigned int s = 0; s < kinetics.n_species(); s++)
+      {
+        columns.push_back(0);
+        if( type == ReactorType::CONSTANT_PRESSURE )
+          for(unsigned int j = 1; j < n; j++)
+            columns.push_back(j);
+        else
+          for(unsigned int q = species_offsets[s]; q < species_offsets[s+1]; q++)
+            columns.push_back(species_columns[q] + 1);
+      }
+
+    return columns;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  bool HomogeneousReactor<CoeffType,NASAFit>::factorize()
+  {
+    using std::abs;
+
+    const unsigned int n = this->n_states();
+
+    if( _linear_solver == ReactorLinearSolver::SPARSE_LU )
+      {
+        for(unsigned int i = 0; i < n; i++)
+          for(unsigned int q = _sparse_offsets[i]; q < _sparse_offsets[i+1]; q++)
+            _sparse_values[q] = _matrix[i*n + _sparse_columns[q]];
+
+        if( !_sparse_lu.factorize( _sparse_values ) )
+          return false;
+
+        _statistics.n_decompositions++;
+
+        return true;
+      }
+
+    for(unsigned int k = 0; k < n; k++)
+      {
+        unsigned int p = k;
+        for(unsigned int i = k+1; i < n; i++)
+          if( abs(_matrix[i*n+k]) > abs(_matrix[p*n+k]) )
+            p = i;
+
+        _pivots[k] = p;
+        if( _matrix[p*n+k] == 0 )
+          return false;
+
+        if( p != k )
+          for(unsigned int j = 0; j < n; j++)
+            std::swap(_matrix[k*n+j], _matrix[p*n+j]);
+
+        const CoeffType inv_pivot = 1 / _matrix[k*n+k];
+        for(unsigned int i = k+1; i < n; i++)
+          {
+            const CoeffType l = _matrix[i*n+k] * inv_pivot;
+            _matrix[i*n+k] = l;
+            if( l != 0 )
+              for(unsigned int j = k+1; j < n; j++)
+                _matrix[i*n+j] -= l * _matrix[k*n+j];
+          }
+      }
+
+    _statistics.n_decompositions++;
+
+    return true;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactor<CoeffType,NASAFit>::solve( std::vector<CoeffType>& x )
+  {
+    if( _linear_solver == ReactorLinearSolver::SPARSE_LU )
+      {
+        _sparse_lu.solve( x );
+        return;
+      }
+
+    const unsigned int n = this->n_states();
+
+    // the rows of L were swapped along with the pivots,
+    // so all the swaps come before the forward substitution
+    for(unsigned int k = 0; k < n; k++)
+      if( _pivots[k] != k )
+        std::swap(x[k], x[_pivots[k]]);
+
+    for(unsigned int k = 0; k < n; k++)
+      for(unsigned int i = k+1; i < n; i++)
+        x[i] -= _matrix[i*n+k] * x[k];
+
+    for(unsigned int k = n; k-- > 0; )
+      {
+        for(unsigned int j = k+1; j < n; j++)
+          x[k] -= _matrix[k*n+j] * x[j];
+        x[k] /= _matrix[k*n+k];
+      }
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  CoeffType HomogeneousReactor<CoeffType,NASAFit>::error_norm( const std::vector<CoeffType>& y,
+                                                               const std::vector<CoeffType>& y_new,
+                                                               const std::vector<CoeffType>& err ) const
+  {
+    using std::abs;
+    using std::max;
+    using std::sqrt;
+
+    CoeffType sum(0);
+    for(unsigned int i = 0; i < y.size(); i++)
+      {
+        const CoeffType scale = _atol + _rtol * max(abs(y[i]), abs(y_new[i]));
+        sum += (err[i] / scale) * (err[i] / scale);
+      }
+
+    return sqrt(sum / y.size());
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  bool HomogeneousReactor<CoeffType,NASAFit>::advance( const CoeffType dt )
+  {
+    using std::max;
+    using std::min;
+    using std::pow;
+
+    antioch_assert_greater( dt, CoeffType(0) );
+    antioch_assert_greater( _rho, CoeffType(0) );
+
+    const unsigned int n = this->n_states();
+
+    // RODAS3 (Sandu et al., 1997), autonomous form: stage i solves
+    // (I/(gamma h) - J) k_i = f(y + sum_j a_ij k_j) + sum_j c_ij k_j / h
+    const CoeffType gamma = 0.5;
+    const CoeffType c21 = 4, c31 = 1, c32 = -1, c41 = 1, c42 = -1, c43 = CoeffType(-8)/3;
+
+    // error of order 3
+    const CoeffType safety = 0.9, min_factor = 0.2, max_factor = 6;
+
+    CoeffType h = (_h > 0) ? _h : dt * CoeffType(1e-3);
+    const CoeffType h_min = dt * 16 * std::numeric_limits<CoeffType>::epsilon();
+
+    CoeffType t = 0;
+    bool new_jacobian = true;
+    bool rejected = false;
+    unsigned int n_attempts = 0;
+
+    while( t < dt )
+      {
+        if( n_attempts++ >= _max_steps || h < h_min )
+          {
+            _h = h;
+            return false;
+          }
+
+        // the last step is shortened to end at dt
+        const bool last = ( t + h >= dt );
+        const CoeffType h_step = last ? dt - t : h;
+
+        if( new_jacobian )
+          {
+            this->compute_rhs_and_jacobian( _y, _f, _jacobian );
+            new_jacobian = false;
+          }
+
+        // iteration matrix
+        const CoeffType diagonal = 1 / (gamma * h_step);
+        for(unsigned int i = 0; i < n*n; i++)
+          _matrix[i] = -_jacobian[i];
+        for(unsigned int i = 0; i < n; i++)
+          _matrix[i*n+i] += diagonal;
+
+        if( !this->factorize() )
+          {
+            h = h_step * min_factor;
+            rejected = true;
+            _statistics.n_rejected++;
+            continue;
+          }
+
+        // stage 1
+        _k1 = _f;
+        this->solve( _k1 );
+
+        // stage 2, same point
+        for(unsigned int i = 0; i < n; i++)
+          _k2[i] = _f[i] + c21 * _k1[i] / h_step;
+        this->solve( _k2 );
+
+        // stage 3
+        for(unsigned int i = 0; i < n; i++)
+          _y_stage[i] = _y[i] + 2 * _k1[i];
+        this->compute_rhs( _y_stage, _k3 );
+        for(unsigned int i = 0; i < n; i++)
+          _k3[i] += (c31 * _k1[i] + c32 * _k2[i]) / h_step;
+        this->solve( _k3 );
+
+        // stage 4
+        for(unsigned int i = 0; i < n; i++)
+          _y_stage[i] = _y[i] + 2 * _k1[i] + _k3[i];
+        this->compute_rhs( _y_stage, _k4 );
+        for(unsigned int i = 0; i < n; i++)
+          _k4[i] += (c41 * _k1[i] + c42 * _k2[i] + c43 * _k3[i]) / h_step;
+        this->solve( _k4 );
+
+        // solution, the last stage being the error estimate
+        for(unsigned int i = 0; i < n; i++)
+          _y_new[i] = _y[i] + 2 * _k1[i] + _k3[i] + _k4[i];
+
+        const CoeffType err = this->error_norm( _y, _y_new, _k4 );
+
+        CoeffType factor = (err > 0) ? safety * pow(err, CoeffType(-1)/3) : max_factor;
+        factor = max(min_factor, min(max_factor, factor));
+
+        // the Jacobian is kept after a rejection, the state being the same
+        if( err <= 1 && _y_new[0] > 0 )
+          {
+            t = last ? dt : t + h_step;
+            _y.swap(_y_new);
+            _statistics.n_steps++;
+            new_jacobian = true;
+
+            // no growth right after a rejection
+            if( rejected )
+              factor = min(factor, CoeffType(1));
+            rejected = false;
+
+            // a shortened last step says nothing of the step size
+            if( !last )
+              h = h_step * factor;
+          }
+        else
+          {
+            _statistics.n_rejected++;
+            rejected = true;
+            h = h_step * min(factor, CoeffType(1));
+          }
+      }
+
+    // start the next call where this one ended
+    _h = h;
+
+    return true;
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_HOMOGENEOUS_REACTOR_H
@@ -0,0 +1,343 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_HOMOGENEOUS_REACTOR_BATCH_H
+#define ANTIOCH_HOMOGENEOUS_REACTOR_BATCH_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/kinetics_evaluator.h"
+#include "antioch/kinetics_batch_evaluator.h"
+#include "antioch/homogeneous_reactor.h"
+
+// C++
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Antioch
+{
+  //! Integrates many independent HomogeneousReactors at once.
+  /*!\class HomogeneousReactorBatch
+   *
+   * Each thread owns one HomogeneousReactor, and with it the kinetics
+   * workspace and the integrator scratch; all of them share the const
+   * KineticsEvaluator, thermodynamics and ChemicalMixture. The reactors are
+   * handed out by the OpenMP runtime with dynamic scheduling, by chunks of
+   * \p chunk_size reactors (1 by default): as the cost of a reactor varies by
+   * orders of magnitude with its stiffness, a thread done with a cheap one
+   * takes the next one instead of waiting on a static share. Without OpenMP
+   * the reactors are integrated in sequence.
+   *
+   * Every reactor starts from the step size given in \p step_sizes (0 for the
+   * HomogeneousReactor default) and gets back its last step size, so that
+   * operator-split steps start where the previous ones ended. The results do
+   * not depend on the number of threads.
+   *
+   * As Antioch errors are exceptions, which cannot leave an OpenMP parallel
+   * region, an error raised while integrating a reactor aborts the program
+   * when running threaded.
+   */
+  template<typename CoeffType=double, typename NASAFit=NASA7CurveFit<CoeffType> >
+  class HomogeneousReactorBatch
+  {
+  public:
+
+    //! Uses the OpenMP default number of threads if \p n_threads is 0.
+    HomogeneousReactorBatch( const KineticsEvaluator<CoeffType>& kinetics,
+                             const NASAThermoMixture<CoeffType,NASAFit>& thermo_mixture,
+                             const ReactorType::ReactorType type,
+                             unsigned int n_threads = 0,
+                             unsigned int chunk_size = 1 );
+
+    ~HomogeneousReactorBatch();
+
+    unsigned int n_threads() const;
+
+    unsigned int n_species() const;
+
+    //! Tolerances of every reactor, see HomogeneousReactor::set_tolerances()
+    void set_tolerances( const CoeffType rtol, const CoeffType atol );
+
+    //! Most steps of every reactor, see HomogeneousReactor::set_max_steps()
+    void set_max_steps( const unsigned int max_steps );
+
+    //! Linear solver of every reactor, see HomogeneousReactor::set_linear_solver()
+    void set_linear_solver( const ReactorLinearSolver::ReactorLinearSolver linear_solver );
+
+    //! Integrates \p n_reactors reactors, reactor r over dt[r]
+    /*! \p T and the molar densities are the initial states on input and the
+     *  final states on output, the molar densities following \p layout.
+     *  \p statistics gets the counters of each reactor. Returns the number
+     *  of reactors whose step size control failed, these reactors being
+     *  left at the state they reached.
+     */
+    unsigned int integrate( unsigned int n_reactors,
+                            std::vector<CoeffType>& T,
+                            std::vector<CoeffType>& molar_densities,
+                            const KineticsBatchLayout& layout,
+                            const std::vector<CoeffType>& dt,
+                            std::vector<ReactorStatistics>& statistics );
+
+    //! Same as above, \p step_sizes giving the first step size of each
+    //! reactor (0 for the default) and getting back the last one
+    unsigned int integrate( unsigned int n_reactors,
+                            std::vector<CoeffType>& T,
+                            std::vector<CoeffType>& molar_densities,
+                            const KineticsBatchLayout& layout,
+                            const std::vector<CoeffType>& dt,
+                            std::vector<CoeffType>& step_sizes,
+                            std::vector<ReactorStatistics>& statistics );
+
+  private:
+
+    //! What each thread needs to integrate one reactor
+    struct ReactorScratch
+    {
+      ReactorScratch( const KineticsEvaluator<CoeffType>& kinetics,
+                      const NASAThermoMixture<CoeffType,NASAFit>& thermo_mixture,
+                      const ReactorType::ReactorType type );
+
+      HomogeneousReactor<CoeffType,NASAFit> reactor;
+
+      std::vector<CoeffType> molar_densities;
+    };
+
+    //! Loops over the reactors, threaded if OpenMP is enabled
+    unsigned int evaluate( unsigned int n_reactors,
+                           std::vector<CoeffType>& T,
+                           std::vector<CoeffType>& molar_densities,
+                           const KineticsBatchLayout& layout,
+                           const std::vector<CoeffType>& dt,
+                           std::vector<CoeffType>* step_sizes,
+                           std::vector<ReactorStatistics>& statistics );
+
+    bool integrate_reactor( unsigned int r,
+                            std::vector<CoeffType>& T,
+                            std::vector<CoeffType>& molar_densities,
+                            const KineticsBatchLayout& layout,
+                            const std::vector<CoeffType>& dt,
+                            std::vector<CoeffType>* step_sizes,
+                            std::vector<ReactorStatistics>& statistics,
+                            ReactorScratch& scratch ) const;
+
+    const KineticsEvaluator<CoeffType>& _kinetics;
+
+    unsigned int _chunk_size;
+
+    //! one per thread
+    std::vector<ReactorScratch> _scratch;
+
+    HomogeneousReactorBatch();
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType, typename NASAFit>
+  inline
+  HomogeneousReactorBatch<CoeffType,NASAFit>::ReactorScratch::ReactorScratch( const KineticsEvaluator<CoeffType>& kinetics,
+                                                                              const NASAThermoMixture<CoeffType,NASAFit>& thermo_mixture,
+                                                                              const ReactorType::ReactorType type )
+    : reactor( kinetics, thermo_mixture, type ),
+      molar_densities( kinetics.n_species(), 0 )
+  {
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  HomogeneousReactorBatch<CoeffType,NASAFit>::HomogeneousReactorBatch( const KineticsEvaluator<CoeffType>& kinetics,
+                                                                       const NASAThermoMixture<CoeffType,NASAFit>& thermo_mixture,
+                                                                       const ReactorType::ReactorType type,
+                                                                       unsigned int n_threads,
+                                                                       unsigned int chunk_size )
+    : _kinetics(kinetics),
+      _chunk_size(chunk_size)
+  {
+    antioch_assert_greater( chunk_size, 0 );
+
+#ifdef _OPENMP
+    if( n_threads == 0 )
+      n_threads = omp_get_max_threads();
+#else
+    // Nothing to share the reactors with
+    n_threads = 1;
+#endif
+
+    // The reactors hold references, so they can be copied but not assigned
+    _scratch.reserve( n_threads );
+    for( unsigned int t = 0; t < n_threads; t++ )
+      _scratch.push_back( ReactorScratch(kinetics, thermo_mixture, type) );
+
+    return;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  HomogeneousReactorBatch<CoeffType,NASAFit>::~HomogeneousReactorBatch()
+  {
+    return;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  unsigned int HomogeneousReactorBatch<CoeffType,NASAFit>::n_threads() const
+  {
+    return _scratch.size();
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  unsigned int HomogeneousReactorBatch<CoeffType,NASAFit>::n_species() const
+  {
+    return _kinetics.n_species();
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactorBatch<CoeffType,NASAFit>::set_tolerances( const CoeffType rtol, const CoeffType atol )
+  {
+    for( unsigned int t = 0; t < _scratch.size(); t++ )
+      _scratch[t].reactor.set_tolerances( rtol, atol );
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactorBatch<CoeffType,NASAFit>::set_max_steps( const unsigned int max_steps )
+  {
+    for( unsigned int t = 0; t < _scratch.size(); t++ )
+      _scratch[t].reactor.set_max_steps( max_steps );
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  void HomogeneousReactorBatch<CoeffType,NASAFit>::set_linear_solver( const ReactorLinearSolver::ReactorLinearSolver linear_solver )
+  {
+    for( unsigned int t = 0; t < _scratch.size(); t++ )
+      _scratch[t].reactor.set_linear_solver( linear_solver );
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  unsigned int HomogeneousReactorBatch<CoeffType,NASAFit>::integrate( unsigned int n_reactors,
+                                                                       std::vector<CoeffType>& T,
+                                                                       std::vector<CoeffType>& molar_densities,
+                                                                       const KineticsBatchLayout& layout,
+                                                                       const std::vector<CoeffType>& dt,
+                                                                       std::vector<ReactorStatistics>& statistics )
+  {
+    return this->evaluate( n_reactors, T, molar_densities, layout, dt, NULL, statistics );
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  unsigned int HomogeneousReactorBatch<CoeffType,NASAFit>::integrate( unsigned int n_reactors,
+                                                                       std::vector<CoeffType>& T,
+                                                                       std::vector<CoeffType>& molar_densities,
+                                                                       const KineticsBatchLayout& layout,
+                                                                       const std::vector<CoeffType>& dt,
+                                                                       std::vector<CoeffType>& step_sizes,
+                                                                       std::vector<ReactorStatistics>& statistics )
+  {
+    antioch_assert_greater_equal( step_sizes.size(), n_reactors );
+
+    return this->evaluate( n_reactors, T, molar_densities, layout, dt, &step_sizes, statistics );
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  unsigned int HomogeneousReactorBatch<CoeffType,NASAFit>::evaluate( unsigned int n_reactors,
+                                                                      std::vector<CoeffType>& T,
+                                                                      std::vector<CoeffType>& molar_densities,
+                                                                      const KineticsBatchLayout& layout,
+                                                                      const std::vector<CoeffType>& dt,
+                                                                      std::vector<CoeffType>* step_sizes,
+                                                                      std::vector<ReactorStatistics>& statistics )
+  {
+    if( n_reactors == 0 )
+      return 0;
+
+    antioch_assert_greater_equal( T.size(), n_reactors );
+    antioch_assert_greater_equal( dt.size(), n_reactors );
+    antioch_assert_greater( molar_densities.size(), layout.index(n_reactors-1,this->n_species()-1) );
+
+    statistics.resize( n_reactors );
+
+    const long n = n_reactors;
+    long n_failed = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,_chunk_size) num_threads(_scratch.size()) reduction(+:n_failed)
+#endif
+    for( long r = 0; r < n; r++ )
+      {
+        unsigned int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        if( !this->integrate_reactor( r, T, molar_densities, layout, dt, step_sizes,
+                                      statistics, _scratch[thread] ) )
+          n_failed++;
+      }
+
+    return n_failed;
+  }
+
+  template<typename CoeffType, typename NASAFit>
+  inline
+  bool HomogeneousReactorBatch<CoeffType,NASAFit>::integrate_reactor( unsigned int r,
+                                                                       std::vector<CoeffType>& T,
+                                                                       std::vector<CoeffType>& molar_densities,
+                                                                       const KineticsBatchLayout& layout,
+                                                                       const std::vector<CoeffType>& dt,
+                                                                       std::vector<CoeffType>* step_sizes,
+                                                                       std::vector<ReactorStatistics>& statistics,
+                                                                       ReactorScratch& scratch ) const
+  {
+    const unsigned int n_species = this->n_species();
+
+    for( unsigned int s = 0; s < n_species; s++ )
+      scratch.molar_densities[s] = molar_densities[layout.index(r,s)];
+
+    // the previous reactor of this thread says nothing of this one
+    scratch.reactor.set_initial_step( step_sizes ? (*step_sizes)[r] : CoeffType(0) );
+
+    const bool success = scratch.reactor.integrate( T[r], scratch.molar_densities, dt[r] );
+
+    for( unsigned int s = 0; s < n_species; s++ )
+      molar_densities[layout.index(r,s)] = scratch.molar_densities[s];
+
+    if( step_sizes )
+      (*step_sizes)[r] = scratch.reactor.step_size();
+
+    statistics[r] = scratch.reactor.statistics();
+
+    return success;
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_HOMOGENEOUS_REACTOR_BATCH_H
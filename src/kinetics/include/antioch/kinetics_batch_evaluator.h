@@ -0,0 +1,473 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_KINETICS_BATCH_EVALUATOR_H
+#define ANTIOCH_KINETICS_BATCH_EVALUATOR_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/kinetics_evaluator.h"
+#include "antioch/kinetics_workspace.h"
+#include "antioch/kinetics_conditions.h"
+
+// C++
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Antioch
+{
+  //! Memory layout of a batch of cells
+  /*! Species s of cell c is stored at c*cell_stride + s*species_stride.
+   *  cell_major(n_species) gives the array of structures layout (all the
+   *  species of a cell are contiguous), species_major(n_cells) the structure
+   *  of arrays layout (a species is contiguous across the cells).
+   */
+  class KineticsBatchLayout
+  {
+  public:
+
+    KineticsBatchLayout( unsigned int cell_stride_in, unsigned int species_stride_in );
+
+    ~KineticsBatchLayout();
+
+    static KineticsBatchLayout cell_major( unsigned int n_species );
+
+    static KineticsBatchLayout species_major( unsigned int n_cells );
+
+    unsigned int index( unsigned int cell, unsigned int species ) const;
+
+    unsigned int cell_stride;
+
+    unsigned int species_stride;
+  };
+
+  //! Evaluates the species source terms of many cells at once.
+  /*!\class KineticsBatchEvaluator
+   *
+   * The cells are distributed among the threads by the OpenMP runtime,
+   * with dynamic scheduling by chunks of \p chunk_size cells, so that an
+   * idle thread picks up the remaining chunks. Without OpenMP the cells are
+   * evaluated in sequence. All the threads share the const KineticsEvaluator
+   * and the thermodynamics evaluator; the per-thread scratch data are
+   * allocated at construction, so a batch evaluation does not allocate.
+   *
+   * The thermodynamics evaluator must provide h_RT_minus_s_R and
+   * dh_RT_minus_s_R_dT (NASAEvaluator, CEAEvaluator, ...). The temperatures are
+   * given per cell, contiguously. The Jacobians are stored per cell, either
+   * dense row-major (n_species*n_species entries) or as the nonzeros of
+   * KineticsEvaluator::jacobian_pattern().
+   *
+   * As Antioch errors are exceptions, which cannot leave an OpenMP parallel
+   * region, an error raised while evaluating a cell aborts the program when
+   * running threaded.
+   */
+  template<typename CoeffType, typename ThermoEvaluator>
+  class KineticsBatchEvaluator
+  {
+  public:
+
+    //! Uses the OpenMP default number of threads if \p n_threads is 0.
+    KineticsBatchEvaluator( const KineticsEvaluator<CoeffType>& kinetics,
+                            const ThermoEvaluator& thermo,
+                            unsigned int n_threads = 0,
+                            unsigned int chunk_size = 16 );
+
+    ~KineticsBatchEvaluator();
+
+    unsigned int n_threads() const;
+
+    unsigned int n_species() const;
+
+    //! Species molar production/destruction rates of \p n_cells cells
+    void compute_mole_sources( unsigned int n_cells,
+                               const std::vector<CoeffType>& T,
+                               const std::vector<CoeffType>& molar_densities,
+                               const KineticsBatchLayout& layout,
+                               std::vector<CoeffType>& mole_sources );
+
+    //! Species mass production/destruction rates of \p n_cells cells
+    void compute_mass_sources( unsigned int n_cells,
+                               const std::vector<CoeffType>& T,
+                               const std::vector<CoeffType>& molar_densities,
+                               const KineticsBatchLayout& layout,
+                               std::vector<CoeffType>& mass_sources );
+
+    //! Molar source terms and dense Jacobians of \p n_cells cells
+    /*! \p dmole_dT follows \p layout, \p dmole_dX_s holds n_cells dense
+     *  row-major blocks.
+     */
+    void compute_mole_sources_and_derivs( unsigned int n_cells,
+                                          const std::vector<CoeffType>& T,
+                                          const std::vector<CoeffType>& molar_densities,
+                                          const KineticsBatchLayout& layout,
+                                          std::vector<CoeffType>& mole_sources,
+                                          std::vector<CoeffType>& dmole_dT,
+                                          std::vector<CoeffType>& dmole_dX_s );
+
+    //! Molar source terms and sparse Jacobians of \p n_cells cells
+    /*! \p dmole_dX_s_nonzeros holds n_cells blocks of
+     *  jacobian_pattern().n_nonzeros() entries.
+     */
+    void compute_mole_sources_and_sparse_derivs( unsigned int n_cells,
+                                                 const std::vector<CoeffType>& T,
+                                                 const std::vector<CoeffType>& molar_densities,
+                                                 const KineticsBatchLayout& layout,
+                                                 std::vector<CoeffType>& mole_sources,
+                                                 std::vector<CoeffType>& dmole_dT,
+                                                 std::vector<CoeffType>& dmole_dX_s_nonzeros );
+
+  private:
+
+    //! What each thread needs to evaluate one cell
+    struct CellScratch
+    {
+      CellScratch( const KineticsEvaluator<CoeffType>& kinetics );
+
+      KineticsWorkspace<CoeffType> workspace;
+
+      std::vector<CoeffType> molar_densities;
+      std::vector<CoeffType> h_RT_minus_s_R;
+      std::vector<CoeffType> dh_RT_minus_s_R_dT;
+      std::vector<CoeffType> sources;
+      std::vector<CoeffType> dsources_dT;
+      std::vector<std::vector<CoeffType> > dsources_dX_s;
+      std::vector<CoeffType> dsources_dX_s_nonzeros;
+    };
+
+    enum BatchOutput { MOLE_SOURCES = 0,
+                       MASS_SOURCES,
+                       DENSE_DERIVS,
+                       SPARSE_DERIVS };
+
+    //! Loops over the cells, threaded if OpenMP is enabled
+    void evaluate( BatchOutput output,
+                   unsigned int n_cells,
+                   const std::vector<CoeffType>& T,
+                   const std::vector<CoeffType>& molar_densities,
+                   const KineticsBatchLayout& layout,
+                   std::vector<CoeffType>& sources,
+                   std::vector<CoeffType>* dsources_dT,
+                   std::vector<CoeffType>* dsources_dX_s );
+
+    void evaluate_cell( BatchOutput output,
+                        unsigned int cell,
+                        const std::vector<CoeffType>& T,
+                        const std::vector<CoeffType>& molar_densities,
+                        const KineticsBatchLayout& layout,
+                        std::vector<CoeffType>& sources,
+                        std::vector<CoeffType>* dsources_dT,
+                        std::vector<CoeffType>* dsources_dX_s,
+                        CellScratch& scratch ) const;
+
+    const KineticsEvaluator<CoeffType>& _kinetics;
+
+    const ThermoEvaluator& _thermo;
+
+    unsigned int _chunk_size;
+
+    //! one per thread
+    std::vector<CellScratch> _scratch;
+
+    KineticsBatchEvaluator();
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  inline
+  KineticsBatchLayout::KineticsBatchLayout( unsigned int cell_stride_in, unsigned int species_stride_in )
+    : cell_stride(cell_stride_in),
+      species_stride(species_stride_in)
+  {
+    return;
+  }
+
+  inline
+  KineticsBatchLayout::~KineticsBatchLayout()
+  {
+    return;
+  }
+
+  inline
+  KineticsBatchLayout KineticsBatchLayout::cell_major( unsigned int n_species )
+  {
+    return KineticsBatchLayout(n_species,1);
+  }
+
+  inline
+  KineticsBatchLayout KineticsBatchLayout::species_major( unsigned int n_cells )
+  {
+    return KineticsBatchLayout(1,n_cells);
+  }
+
+  inline
+  unsigned int KineticsBatchLayout::index( unsigned int cell, unsigned int species ) const
+  {
+    return cell*cell_stride + species*species_stride;
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::CellScratch::CellScratch( const KineticsEvaluator<CoeffType>& kinetics )
+    : workspace( kinetics.reaction_set(), 0 ),
+      molar_densities( kinetics.n_species(), 0 ),
+      h_RT_minus_s_R( kinetics.n_species(), 0 ),
+      dh_RT_minus_s_R_dT( kinetics.n_species(), 0 ),
+      sources( kinetics.n_species(), 0 ),
+      dsources_dT( kinetics.n_species(), 0 ),
+      dsources_dX_s( kinetics.n_species(), std::vector<CoeffType>(kinetics.n_species(),0) ),
+      dsources_dX_s_nonzeros( kinetics.jacobian_pattern().n_nonzeros(), 0 )
+  {
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::KineticsBatchEvaluator( const KineticsEvaluator<CoeffType>& kinetics,
+                                                                             const ThermoEvaluator& thermo,
+                                                                             unsigned int n_threads,
+                                                                             unsigned int chunk_size )
+    : _kinetics(kinetics),
+      _thermo(thermo),
+      _chunk_size(chunk_size)
+  {
+    antioch_assert_greater( chunk_size, 0 );
+
+#ifdef _OPENMP
+    if( n_threads == 0 )
+      n_threads = omp_get_max_threads();
+#else
+    // Nothing to share the cells with
+    n_threads = 1;
+#endif
+
+    _scratch.resize( n_threads, CellScratch(kinetics) );
+
+    return;
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::~KineticsBatchEvaluator()
+  {
+    return;
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  unsigned int KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::n_threads() const
+  {
+    return _scratch.size();
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  unsigned int KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::n_species() const
+  {
+    return _kinetics.n_species();
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  void KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::compute_mole_sources( unsigned int n_cells,
+                                                                                const std::vector<CoeffType>& T,
+                                                                                const std::vector<CoeffType>& molar_densities,
+                                                                                const KineticsBatchLayout& layout,
+                                                                                std::vector<CoeffType>& mole_sources )
+  {
+    this->evaluate( MOLE_SOURCES, n_cells, T, molar_densities, layout,
+                    mole_sources, NULL, NULL );
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  void KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::compute_mass_sources( unsigned int n_cells,
+                                                                                const std::vector<CoeffType>& T,
+                                                                                const std::vector<CoeffType>& molar_densities,
+                                                                                const KineticsBatchLayout& layout,
+                                                                                std::vector<CoeffType>& mass_sources )
+  {
+    this->evaluate( MASS_SOURCES, n_cells, T, molar_densities, layout,
+                    mass_sources, NULL, NULL );
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  void KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::compute_mole_sources_and_derivs( unsigned int n_cells,
+                                                                                           const std::vector<CoeffType>& T,
+                                                                                           const std::vector<CoeffType>& molar_densities,
+                                                                                           const KineticsBatchLayout& layout,
+                                                                                           std::vector<CoeffType>& mole_sources,
+                                                                                           std::vector<CoeffType>& dmole_dT,
+                                                                                           std::vector<CoeffType>& dmole_dX_s )
+  {
+    antioch_assert_greater_equal( dmole_dX_s.size(), n_cells * this->n_species() * this->n_species() );
+
+    this->evaluate( DENSE_DERIVS, n_cells, T, molar_densities, layout,
+                    mole_sources, &dmole_dT, &dmole_dX_s );
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  void KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::compute_mole_sources_and_sparse_derivs( unsigned int n_cells,
+                                                                                                  const std::vector<CoeffType>& T,
+                                                                                                  const std::vector<CoeffType>& molar_densities,
+                                                                                                  const KineticsBatchLayout& layout,
+                                                                                                  std::vector<CoeffType>& mole_sources,
+                                                                                                  std::vector<CoeffType>& dmole_dT,
+                                                                                                  std::vector<CoeffType>& dmole_dX_s_nonzeros )
+  {
+    antioch_assert_greater_equal( dmole_dX_s_nonzeros.size(), n_cells * _kinetics.jacobian_pattern().n_nonzeros() );
+
+    this->evaluate( SPARSE_DERIVS, n_cells, T, molar_densities, layout,
+                    mole_sources, &dmole_dT, &dmole_dX_s_nonzeros );
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  void KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::evaluate( BatchOutput output,
+                                                                    unsigned int n_cells,
+                                                                    const std::vector<CoeffType>& T,
+                                                                    const std::vector<CoeffType>& molar_densities,
+                                                                    const KineticsBatchLayout& layout,
+                                                                    std::vector<CoeffType>& sources,
+                                                                    std::vector<CoeffType>* dsources_dT,
+                                                                    std::vector<CoeffType>* dsources_dX_s )
+  {
+    if( n_cells == 0 )
+      return;
+
+    antioch_assert_greater_equal( T.size(), n_cells );
+    antioch_assert_greater( molar_densities.size(), layout.index(n_cells-1,this->n_species()-1) );
+    antioch_assert_greater( sources.size(), layout.index(n_cells-1,this->n_species()-1) );
+    if( dsources_dT )
+      antioch_assert_greater( dsources_dT->size(), layout.index(n_cells-1,this->n_species()-1) );
+
+    const long n = n_cells;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,_chunk_size) num_threads(_scratch.size())
+#endif
+    for( long cell = 0; cell < n; cell++ )
+      {
+        unsigned int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        this->evaluate_cell( output, cell, T, molar_densities, layout,
+                             sources, dsources_dT, dsources_dX_s,
+                             _scratch[thread] );
+      }
+  }
+
+  template<typename CoeffType, typename ThermoEvaluator>
+  inline
+  void KineticsBatchEvaluator<CoeffType,ThermoEvaluator>::evaluate_cell( BatchOutput output,
+                                                                         unsigned int cell,
+                                                                         const std::vector<CoeffType>& T,
+                                                                         const std::vector<CoeffType>& molar_densities,
+                                                                         const KineticsBatchLayout& layout,
+                                                                         std::vector<CoeffType>& sources,
+                                                                         std::vector<CoeffType>* dsources_dT,
+                                                                         std::vector<CoeffType>* dsources_dX_s,
+                                                                         CellScratch& scratch ) const
+  {
+    const unsigned int n_species = this->n_species();
+
+    for( unsigned int s = 0; s < n_species; s++ )
+      scratch.molar_densities[s] = molar_densities[layout.index(cell,s)];
+
+    const KineticsConditions<CoeffType> conditions( T[cell] );
+
+    _thermo.h_RT_minus_s_R( conditions.temp_cache(), scratch.h_RT_minus_s_R );
+
+    switch( output )
+      {
+      case( MOLE_SOURCES ):
+        {
+          _kinetics.compute_mole_sources( conditions, scratch.molar_densities,
+                                          scratch.h_RT_minus_s_R, scratch.sources,
+                                          scratch.workspace );
+        }
+        break;
+
+      case( MASS_SOURCES ):
+        {
+          _kinetics.compute_mass_sources( conditions, scratch.molar_densities,
+                                          scratch.h_RT_minus_s_R, scratch.sources,
+                                          scratch.workspace );
+        }
+        break;
+
+      case( DENSE_DERIVS ):
+        {
+          _thermo.dh_RT_minus_s_R_dT( conditions.temp_cache(), scratch.dh_RT_minus_s_R_dT );
+
+          _kinetics.compute_mole_sources_and_derivs( conditions, scratch.molar_densities,
+                                                     scratch.h_RT_minus_s_R, scratch.dh_RT_minus_s_R_dT,
+                                                     scratch.sources, scratch.dsources_dT,
+                                                     scratch.dsources_dX_s, scratch.workspace );
+
+          const unsigned int offset = cell * n_species * n_species;
+          for( unsigned int s = 0; s < n_species; s++ )
+            for( unsigned int t = 0; t < n_species; t++ )
+              (*dsources_dX_s)[offset + s*n_species + t] = scratch.dsources_dX_s[s][t];
+        }
+        break;
+
+      case( SPARSE_DERIVS ):
+        {
+          _thermo.dh_RT_minus_s_R_dT( conditions.temp_cache(), scratch.dh_RT_minus_s_R_dT );
+
+          _kinetics.compute_mole_sources_and_sparse_derivs( conditions, scratch.molar_densities,
+                                                            scratch.h_RT_minus_s_R, scratch.dh_RT_minus_s_R_dT,
+                                                            scratch.sources, scratch.dsources_dT,
+                                                            scratch.dsources_dX_s_nonzeros, scratch.workspace );
+
+          const unsigned int n_nonzeros = scratch.dsources_dX_s_nonzeros.size();
+          const unsigned int offset = cell * n_nonzeros;
+          for( unsigned int n = 0; n < n_nonzeros; n++ )
+            (*dsources_dX_s)[offset + n] = scratch.dsources_dX_s_nonzeros[n];
+        }
+        break;
+
+      default:
+        {
+          antioch_error();
+        }
+      }
+
+    for( unsigned int s = 0; s < n_species; s++ )
+      sources[layout.index(cell,s)] = scratch.sources[s];
+
+    if( dsources_dT )
+      for( unsigned int s = 0; s < n_species; s++ )
+        (*dsources_dT)[layout.index(cell,s)] = scratch.dsources_dT[s];
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_KINETICS_BATCH_EVALUATOR_H
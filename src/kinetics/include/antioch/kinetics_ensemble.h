@@ -0,0 +1,257 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_KINETICS_ENSEMBLE_H
+#define ANTIOCH_KINETICS_ENSEMBLE_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/reaction_set.h"
+#include "antioch/reaction_parameter_handle.h"
+#include "antioch/stoichiometric_matrix.h"
+#include "antioch/kinetics_workspace.h"
+#include "antioch/kinetics_conditions.h"
+
+// C++
+#include <vector>
+#include <algorithm>
+
+namespace Antioch
+{
+  //! Evaluates the species source terms of one state for many parameter samples.
+  /*!\class KineticsEnsemble
+   *
+   * The parameters are given by handles (see ReactionSet::parameter_handle()),
+   * a sample being one value per handle, in the unit of the handle.
+   * Everything that does not depend on the sampled parameters is evaluated
+   * once per state: the equilibrium constants, the concentration products
+   * and the rates of progress of the reactions no handle refers to. A sample
+   * then only costs the rates of progress of the sampled reactions, whose
+   * change is scattered onto the nominal source terms.
+   *
+   * The samples are applied to the reaction set during the evaluation,
+   * the nominal values (the ones at construction) are set back afterwards:
+   * the reaction set must not be used concurrently with an ensemble evaluation.
+   * The reverse rate constants explicitly given to a reaction (see
+   * Reaction::set_reverse_rate()) are not sampled with its forward one.
+   */
+  template<typename CoeffType=double>
+  class KineticsEnsemble
+  {
+  public:
+
+    KineticsEnsemble( ReactionSet<CoeffType>& reaction_set,
+                      const std::vector<ReactionParameterHandle<CoeffType> >& handles );
+
+    ~KineticsEnsemble();
+
+    unsigned int n_species() const;
+
+    unsigned int n_parameters() const;
+
+    unsigned int n_samples() const;
+
+    //! \returns the number of reactions whose parameters are sampled.
+    unsigned int n_sampled_reactions() const;
+
+    //! \returns the values of the parameters at construction.
+    const std::vector<CoeffType>& nominal_values() const;
+
+    //! Sets the samples
+    /*! \p values holds \p n_samples rows of n_parameters() values.
+     */
+    void set_samples( unsigned int n_samples, const std::vector<CoeffType>& values );
+
+    //! Species molar production/destruction rates of every sample
+    /*! \p mole_sources is resized to n_samples() rows of n_species() values.
+     */
+    template <typename VectorStateType>
+    void compute_mole_sources( const KineticsConditions<CoeffType,VectorStateType>& conditions,
+                               const VectorStateType& molar_densities,
+                               const VectorStateType& h_RT_minus_s_R,
+                               std::vector<CoeffType>& mole_sources );
+
+  private:
+
+    ReactionSet<CoeffType>& _reaction_set;
+
+    std::vector<ReactionParameterHandle<CoeffType> > _handles;
+
+    std::vector<CoeffType> _nominal_values;
+
+    //! sorted, without repetition
+    std::vector<unsigned int> _sampled_reactions;
+
+    StoichiometricMatrix<CoeffType> _stoichiometry;
+
+    KineticsWorkspace<CoeffType> _workspace;
+
+    unsigned int _n_samples;
+
+    std::vector<CoeffType> _samples;
+
+    std::vector<CoeffType> _nominal_sources;
+
+    KineticsEnsemble();
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+
+  template<typename CoeffType>
+  inline
+  KineticsEnsemble<CoeffType>::KineticsEnsemble( ReactionSet<CoeffType>& reaction_set,
+                                                 const std::vector<ReactionParameterHandle<CoeffType> >& handles )
+    : _reaction_set(reaction_set),
+      _handles(handles),
+      _nominal_values(handles.size()),
+      _stoichiometry(reaction_set),
+      _workspace(reaction_set,0),
+      _n_samples(0),
+      _nominal_sources(reaction_set.n_species(),0)
+  {
+    for( unsigned int i = 0; i < _handles.size(); i++ )
+      {
+        _nominal_values[i] = _reaction_set.get_parameter(_handles[i]);
+        _sampled_reactions.push_back(_handles[i].reaction);
+      }
+
+    std::sort( _sampled_reactions.begin(), _sampled_reactions.end() );
+    _sampled_reactions.erase( std::unique( _sampled_reactions.begin(), _sampled_reactions.end() ),
+                              _sampled_reactions.end() );
+
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  KineticsEnsemble<CoeffType>::~KineticsEnsemble()
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int KineticsEnsemble<CoeffType>::n_species() const
+  {
+    return _reaction_set.n_species();
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int KineticsEnsemble<CoeffType>::n_parameters() const
+  {
+    return _handles.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int KineticsEnsemble<CoeffType>::n_samples() const
+  {
+    return _n_samples;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int KineticsEnsemble<CoeffType>::n_sampled_reactions() const
+  {
+    return _sampled_reactions.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<CoeffType>& KineticsEnsemble<CoeffType>::nominal_values() const
+  {
+    return _nominal_values;
+  }
+
+  template<typename CoeffType>
+  inline
+  void KineticsEnsemble<CoeffType>::set_samples( unsigned int n_samples, const std::vector<CoeffType>& values )
+  {
+    antioch_assert_equal_to( values.size(), n_samples * this->n_parameters() );
+
+    _n_samples = n_samples;
+    _samples = values;
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template <typename VectorStateType>
+  inline
+  void KineticsEnsemble<CoeffType>::compute_mole_sources( const KineticsConditions<CoeffType,VectorStateType>& conditions,
+                                                          const VectorStateType& molar_densities,
+                                                          const VectorStateType& h_RT_minus_s_R,
+                                                          std::vector<CoeffType>& mole_sources )
+  {
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+
+    const unsigned int n_species = this->n_species();
+    const unsigned int n_parameters = this->n_parameters();
+
+    // nominal rates, which also leaves the equilibrium constants in the workspace
+    _reaction_set.compute_reaction_rates( conditions, molar_densities, h_RT_minus_s_R,
+                                          _workspace.net_reaction_rates, _workspace );
+
+    _stoichiometry.multiply( _workspace.net_reaction_rates, _nominal_sources );
+
+    mole_sources.resize( _n_samples * n_species );
+
+    const std::vector<unsigned int>& column_offsets = _stoichiometry.column_offsets();
+    const std::vector<unsigned int>& column_species = _stoichiometry.column_species();
+    const std::vector<CoeffType>& column_coefficients = _stoichiometry.column_coefficients();
+
+    for( unsigned int sample = 0; sample < _n_samples; sample++ )
+      {
+        for( unsigned int i = 0; i < n_parameters; i++ )
+          _reaction_set.set_parameter( _handles[i], _samples[sample * n_parameters + i] );
+
+        std::copy( _nominal_sources.begin(), _nominal_sources.end(),
+                   mole_sources.begin() + sample * n_species );
+
+        for( unsigned int i = 0; i < _sampled_reactions.size(); i++ )
+          {
+            const unsigned int rxn = _sampled_reactions[i];
+
+            const CoeffType delta_rate =
+              _reaction_set.reaction(rxn).compute_rate_of_progress( molar_densities, conditions, _workspace.keq[rxn] )
+              - _workspace.net_reaction_rates[rxn];
+
+            for( unsigned int k = column_offsets[rxn]; k < column_offsets[rxn+1]; k++ )
+              mole_sources[sample * n_species + column_species[k]] += column_coefficients[k] * delta_rate;
+          }
+      }
+
+    // back to the nominal mechanism
+    _reaction_set.set_parameters( _handles, _nominal_values );
+
+    return;
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_KINETICS_ENSEMBLE_H
@@ -30,6 +30,11 @@
 // Antioch
 #include "antioch/metaprogramming.h"
 #include "antioch/reaction_set.h"
+#include "antioch/compiled_reaction_set.h"
+#include "antioch/stoichiometric_matrix.h"
+#include "antioch/kinetics_jacobian_pattern.h"
+#include "antioch/active_reactions.h"
+#include "antioch/kinetics_workspace.h"
 #include "antioch/kinetics_conditions.h"
 
 // C++
@@ -45,9 +50,13 @@ namespace Antioch
   class ChemicalMixture;
   
   //! Class to handle computing mass source terms for a given ReactionSet.
-  /*! This class preallocates work arrays and so *must* be created within a spawned
-   *  thread, if running in a threaded environment. It takes a reference to an
-   *  already created ReactionSet, so there's little construction penalty.
+  /*! This class preallocates work arrays used by the non-const evaluations
+   *  and so these *must* be called on an evaluator created within a spawned
+   *  thread, if running in a threaded environment. The const evaluations
+   *  take an explicit KineticsWorkspace instead, so one evaluator can be
+   *  shared by all threads as long as each thread owns its workspace.
+   *  It takes a reference to an already created ReactionSet, so there's
+   *  little construction penalty.
    */
   template<typename CoeffType=double, typename StateType=CoeffType>
   class KineticsEvaluator
@@ -62,6 +71,12 @@ namespace Antioch
     KineticsEvaluator( const ReactionSet<CoeffType>& reaction_set,
                        const StateType& example );
 
+    //! Constructor.  Same as above, but the reaction rates are evaluated
+    //by the compiled (flat) version of the reaction set.  The compiled
+    //set must outlive the evaluator.
+    KineticsEvaluator( const CompiledReactionSet<CoeffType>& compiled_set,
+                       const StateType& example );
+
     ~KineticsEvaluator();
 
     const ReactionSet<CoeffType>& reaction_set() const;
@@ -73,6 +88,14 @@ namespace Antioch
                                const VectorStateType& molar_densities,
                                const VectorStateType& h_RT_minus_s_R,
                                VectorStateType& mass_sources );
+
+    //! Thread-safe version of compute_mass_sources, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mass_sources( const KC& conditions,
+                               const VectorStateType& molar_densities,
+                               const VectorStateType& h_RT_minus_s_R,
+                               VectorStateType& mass_sources,
+                               KineticsWorkspace<StateType>& workspace ) const;
     
     //! Compute species production/destruction rate derivatives
     /*! In mass units, e.g. \f$ \frac{\partial \dot{\omega}}{dT}
@@ -86,6 +109,17 @@ namespace Antioch
                                           VectorStateType& dmass_dT,
                                           std::vector<VectorStateType>& dmass_drho_s );
 
+    //! Thread-safe version of compute_mass_sources_and_derivs, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mass_sources_and_derivs( const KC& conditions,
+                                          const VectorStateType& molar_densities,
+                                          const VectorStateType& h_RT_minus_s_R,
+                                          const VectorStateType& dh_RT_minus_s_R_dT,
+                                          VectorStateType& mass_sources,
+                                          VectorStateType& dmass_dT,
+                                          std::vector<VectorStateType>& dmass_drho_s,
+                                          KineticsWorkspace<StateType>& workspace ) const;
+
     //! Compute species molar production/destruction rates per unit volume
     /*! \f$ \left(mole/sec/m^3\right)\f$ */
     template <typename VectorStateType, typename KC>
@@ -94,6 +128,57 @@ namespace Antioch
                                const VectorStateType& h_RT_minus_s_R,
                                VectorStateType& mole_sources );
 
+    //! Thread-safe version of compute_mole_sources, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources( const KC& conditions,
+                               const VectorStateType& molar_densities,
+                               const VectorStateType& h_RT_minus_s_R,
+                               VectorStateType& mole_sources,
+                               KineticsWorkspace<StateType>& workspace ) const;
+
+    //! Compute the molar sources of the \p active reactions only
+    /*! The rates of progress are evaluated by the Reaction objects, one
+     *  active reaction at a time, also with a CompiledReactionSet. The
+     *  skipped contributions are given by compute_mole_sources_mask_error().
+     */
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources( const KC& conditions,
+                               const VectorStateType& molar_densities,
+                               const VectorStateType& h_RT_minus_s_R,
+                               const ActiveReactions<CoeffType>& active,
+                               VectorStateType& mole_sources );
+
+    //! Thread-safe version of compute_mole_sources with \p active reactions, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources( const KC& conditions,
+                               const VectorStateType& molar_densities,
+                               const VectorStateType& h_RT_minus_s_R,
+                               const ActiveReactions<CoeffType>& active,
+                               VectorStateType& mole_sources,
+                               KineticsWorkspace<StateType>& workspace ) const;
+
+    //! Bound of the molar sources of the reactions masked by \p active
+    /*! \p error_bound is \f$ \sum_{r \notin \text{active}} |\nu_{s,r} R_r| \f$,
+     *  computed at this state by evaluating the inactive reactions. Meant
+     *  to be called when \p active is updated, to accept or tighten the
+     *  thresholds, not at each evaluation.
+     */
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_mask_error( const KC& conditions,
+                                          const VectorStateType& molar_densities,
+                                          const VectorStateType& h_RT_minus_s_R,
+                                          const ActiveReactions<CoeffType>& active,
+                                          VectorStateType& error_bound );
+
+    //! Thread-safe version of compute_mole_sources_mask_error, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_mask_error( const KC& conditions,
+                                          const VectorStateType& molar_densities,
+                                          const VectorStateType& h_RT_minus_s_R,
+                                          const ActiveReactions<CoeffType>& active,
+                                          VectorStateType& error_bound,
+                                          KineticsWorkspace<StateType>& workspace ) const;
+
     //! Compute species production/destruction rate derivatives
     /*! In mass units, e.g. \f$ \frac{\partial \dot{\omega}}{dT}
       [\left(mole/sec/m^3/K\right)]\f$ */
@@ -106,21 +191,164 @@ namespace Antioch
                                           VectorStateType& dmole_dT,
                                           std::vector<VectorStateType>& dmole_dX_s );
 
+    //! Thread-safe version of compute_mole_sources_and_derivs, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_and_derivs( const KC& conditions,
+                                          const VectorStateType& molar_densities,
+                                          const VectorStateType& h_RT_minus_s_R,
+                                          const VectorStateType& dh_RT_minus_s_R_dT,
+                                          VectorStateType& mole_sources,
+                                          VectorStateType& dmole_dT,
+                                          std::vector<VectorStateType>& dmole_dX_s,
+                                          KineticsWorkspace<StateType>& workspace ) const;
+
+    //! Compute species molar production/destruction rate sparse derivatives
+    /*! Same as compute_mole_sources_and_derivs, but only the structurally
+     *  nonzero entries of \f$ \frac{\partial \dot{\omega}}{\partial c} \f$
+     *  are computed, in the order given by jacobian_pattern().
+     *  \p dmole_dX_s_nonzeros must have jacobian_pattern().n_nonzeros() entries.
+     */
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_and_sparse_derivs( const KC& conditions,
+                                                 const VectorStateType& molar_densities,
+                                                 const VectorStateType& h_RT_minus_s_R,
+                                                 const VectorStateType& dh_RT_minus_s_R_dT,
+                                                 VectorStateType& mole_sources,
+                                                 VectorStateType& dmole_dT,
+                                                 VectorStateType& dmole_dX_s_nonzeros );
+
+    //! Thread-safe version of compute_mole_sources_and_sparse_derivs, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_and_sparse_derivs( const KC& conditions,
+                                                 const VectorStateType& molar_densities,
+                                                 const VectorStateType& h_RT_minus_s_R,
+                                                 const VectorStateType& dh_RT_minus_s_R_dT,
+                                                 VectorStateType& mole_sources,
+                                                 VectorStateType& dmole_dT,
+                                                 VectorStateType& dmole_dX_s_nonzeros,
+                                                 KineticsWorkspace<StateType>& workspace ) const;
+
+    //! Compute the molar sources and their rate constants parameters derivatives
+    /*! Sparse derivatives of the molar sources with respect to \f$\ln A_i\f$ and
+     *  \f$E_{a,i}\f$ (in J/mol) of every rate constant \f$i\f$, numbered as in
+     *  ReactionSet::compute_rate_of_progress_sensitivities(). The entries of
+     *  the rate constant \f$i\f$ of the reaction \f$r\f$ are consecutive, and
+     *  follow the species of the column \f$r\f$ of stoichiometric_matrix().
+     *  \p dmole_dlnA and \p dmole_dEa must have n_sensitivity_nonzeros() entries.
+     *  The rates of progress are evaluated by the ReactionSet.
+     */
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_sensitivities( const KC& conditions,
+                                             const VectorStateType& molar_densities,
+                                             const VectorStateType& h_RT_minus_s_R,
+                                             VectorStateType& mole_sources,
+                                             VectorStateType& dmole_dlnA,
+                                             VectorStateType& dmole_dEa );
+
+    //! Thread-safe version of compute_mole_sources_sensitivities, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_sensitivities( const KC& conditions,
+                                             const VectorStateType& molar_densities,
+                                             const VectorStateType& h_RT_minus_s_R,
+                                             VectorStateType& mole_sources,
+                                             VectorStateType& dmole_dlnA,
+                                             VectorStateType& dmole_dEa,
+                                             KineticsWorkspace<StateType>& workspace ) const;
+
+    //! Number of entries of the sparse derivatives of compute_mole_sources_sensitivities()
+    unsigned int n_sensitivity_nonzeros() const;
+
+    //! Compute the molar sources and a directional derivative, without forming the Jacobian
+    /*! \p jvp is \f$ \frac{\partial \dot{\omega}}{\partial T} v_T +
+     *  \frac{\partial \dot{\omega}}{\partial c} v_c \f$. With a CompiledReactionSet
+     *  the cost is that of one evaluation of the rates with their temperature
+     *  derivatives; the ReactionSet falls back to the dense derivatives.
+     */
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_jvp( const KC& conditions,
+                                   const VectorStateType& molar_densities,
+                                   const VectorStateType& h_RT_minus_s_R,
+                                   const VectorStateType& dh_RT_minus_s_R_dT,
+                                   const StateType& v_T,
+                                   const VectorStateType& v_X,
+                                   VectorStateType& mole_sources,
+                                   VectorStateType& jvp );
+
+    //! Thread-safe version of compute_mole_sources_jvp, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_jvp( const KC& conditions,
+                                   const VectorStateType& molar_densities,
+                                   const VectorStateType& h_RT_minus_s_R,
+                                   const VectorStateType& dh_RT_minus_s_R_dT,
+                                   const StateType& v_T,
+                                   const VectorStateType& v_X,
+                                   VectorStateType& mole_sources,
+                                   VectorStateType& jvp,
+                                   KineticsWorkspace<StateType>& workspace ) const;
+
+    //! Compute the molar sources and the transposed Jacobian applied to \p w
+    /*! \p w_dT is \f$ w^T \frac{\partial \dot{\omega}}{\partial T} \f$ and
+     *  \p w_dX is \f$ \left(\frac{\partial \dot{\omega}}{\partial c}\right)^T w \f$,
+     *  for adjoint sensitivities and Krylov solvers.
+     */
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_vjp( const KC& conditions,
+                                   const VectorStateType& molar_densities,
+                                   const VectorStateType& h_RT_minus_s_R,
+                                   const VectorStateType& dh_RT_minus_s_R_dT,
+                                   const VectorStateType& w,
+                                   VectorStateType& mole_sources,
+                                   StateType& w_dT,
+                                   VectorStateType& w_dX );
+
+    //! Thread-safe version of compute_mole_sources_vjp, using the scratch \p workspace
+    template <typename VectorStateType, typename KC>
+    void compute_mole_sources_vjp( const KC& conditions,
+                                   const VectorStateType& molar_densities,
+                                   const VectorStateType& h_RT_minus_s_R,
+                                   const VectorStateType& dh_RT_minus_s_R_dT,
+                                   const VectorStateType& w,
+                                   VectorStateType& mole_sources,
+                                   StateType& w_dT,
+                                   VectorStateType& w_dX,
+                                   KineticsWorkspace<StateType>& workspace ) const;
+
     unsigned int n_species() const;
 
     unsigned int n_reactions() const;
 
+    //! Net stoichiometric matrix used to scatter the rates of progress.
+    /*! Built at construction: the reaction set must not be modified
+     *  during the lifetime of the evaluator. Its transpose_multiply()
+     *  gives the adjoint of the source terms with respect to the rates.
+     */
+    const StoichiometricMatrix<CoeffType>& stoichiometric_matrix() const;
+
+    //! CSR sparsity pattern of the species source terms Jacobian.
+    const KineticsJacobianPattern<CoeffType>& jacobian_pattern() const;
+
+    //! Reuse the rate and equilibrium constants while the temperature is unchanged
+    /*! Applies to the non-const evaluations, see
+     *  KineticsWorkspace::enable_temperature_cache(). Only the compiled
+     *  version of the reaction set caches anything.
+     */
+    void enable_temperature_cache( bool enable = true );
+
   protected:
 
     const ReactionSet<CoeffType>& _reaction_set;
 
     const ChemicalMixture<CoeffType>& _chem_mixture;
 
-    std::vector<StateType> _net_reaction_rates;
+    //! NULL if the rates are evaluated by the ReactionSet
+    const CompiledReactionSet<CoeffType>* _compiled_set;
 
-    std::vector<StateType> _dnet_rate_dT;
+    const StoichiometricMatrix<CoeffType> _stoichiometry;
 
-    std::vector<std::vector<StateType> > _dnet_rate_dX_s;
+    const KineticsJacobianPattern<CoeffType> _jacobian_pattern;
+
+    //! scratch space of the non-const evaluations
+    KineticsWorkspace<StateType> _workspace;
   };
 
   /* ------------------------- Inline Functions -------------------------*/
@@ -138,6 +366,18 @@ namespace Antioch
     return _chem_mixture.n_species();
   }
 
+  template<typename CoeffType, typename StateType>
+  inline
+  unsigned int KineticsEvaluator<CoeffType,StateType>::n_sensitivity_nonzeros() const
+  {
+    unsigned int n(0);
+    for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+      n += _reaction_set.reaction(rxn).n_rate_constants() *
+           (_stoichiometry.column_offsets()[rxn+1] - _stoichiometry.column_offsets()[rxn]);
+
+    return n;
+  }
+
   template<typename CoeffType, typename StateType>
   inline
   unsigned int KineticsEvaluator<CoeffType,StateType>::n_reactions() const
@@ -145,6 +385,27 @@ namespace Antioch
     return _reaction_set.n_reactions();
   }
 
+  template<typename CoeffType, typename StateType>
+  inline
+  const StoichiometricMatrix<CoeffType>& KineticsEvaluator<CoeffType,StateType>::stoichiometric_matrix() const
+  {
+    return _stoichiometry;
+  }
+
+  template<typename CoeffType, typename StateType>
+  inline
+  const KineticsJacobianPattern<CoeffType>& KineticsEvaluator<CoeffType,StateType>::jacobian_pattern() const
+  {
+    return _jacobian_pattern;
+  }
+
+
+  template<typename CoeffType, typename StateType>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::enable_temperature_cache( bool enable )
+  {
+    _workspace.enable_temperature_cache(enable);
+  }
 
   template<typename CoeffType, typename StateType>
   inline
@@ -153,16 +414,26 @@ namespace Antioch
     const StateType& example )
     : _reaction_set( reaction_set ),
       _chem_mixture( reaction_set.chemical_mixture() ),
-      _net_reaction_rates( reaction_set.n_reactions(), example ),
-      _dnet_rate_dT( reaction_set.n_reactions(), example ),
-      _dnet_rate_dX_s( reaction_set.n_reactions() )
+      _compiled_set( NULL ),
+      _stoichiometry( reaction_set ),
+      _jacobian_pattern( reaction_set, _stoichiometry ),
+      _workspace( reaction_set, example )
   {
+    return;
+  }
 
-    for( unsigned int r = 0; r < this->n_reactions(); r++ )
-      {
-        _dnet_rate_dX_s[r].resize( reaction_set.n_species(), example );
-      }
-
+  template<typename CoeffType, typename StateType>
+  inline
+  KineticsEvaluator<CoeffType,StateType>::KineticsEvaluator
+  ( const CompiledReactionSet<CoeffType>& compiled_set,
+    const StateType& example )
+    : _reaction_set( compiled_set.reaction_set() ),
+      _chem_mixture( compiled_set.chemical_mixture() ),
+      _compiled_set( &compiled_set ),
+      _stoichiometry( compiled_set.reaction_set() ),
+      _jacobian_pattern( compiled_set.reaction_set(), _stoichiometry ),
+      _workspace( compiled_set.reaction_set(), example )
+  {
     return;
   }
 
@@ -181,55 +452,180 @@ namespace Antioch
                                                                      const VectorStateType& molar_densities,
                                                                      const VectorStateType& h_RT_minus_s_R,
                                                                      VectorStateType& mole_sources )
+  {
+    this->compute_mole_sources( conditions, molar_densities, h_RT_minus_s_R,
+                                mole_sources, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources( const KC& conditions,
+                                                                     const VectorStateType& molar_densities,
+                                                                     const VectorStateType& h_RT_minus_s_R,
+                                                                     const ActiveReactions<CoeffType>& active,
+                                                                     VectorStateType& mole_sources )
+  {
+    this->compute_mole_sources( conditions, molar_densities, h_RT_minus_s_R,
+                                active, mole_sources, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_mask_error( const KC& conditions,
+                                                                                const VectorStateType& molar_densities,
+                                                                                const VectorStateType& h_RT_minus_s_R,
+                                                                                const ActiveReactions<CoeffType>& active,
+                                                                                VectorStateType& error_bound )
+  {
+    this->compute_mole_sources_mask_error( conditions, molar_densities, h_RT_minus_s_R,
+                                           active, error_bound, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_sensitivities( const KC& conditions,
+                                                                                   const VectorStateType& molar_densities,
+                                                                                   const VectorStateType& h_RT_minus_s_R,
+                                                                                   VectorStateType& mole_sources,
+                                                                                   VectorStateType& dmole_dlnA,
+                                                                                   VectorStateType& dmole_dEa )
+  {
+    this->compute_mole_sources_sensitivities( conditions, molar_densities, h_RT_minus_s_R,
+                                              mole_sources, dmole_dlnA, dmole_dEa, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_jvp( const KC& conditions,
+                                                                         const VectorStateType& molar_densities,
+                                                                         const VectorStateType& h_RT_minus_s_R,
+                                                                         const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                         const StateType& v_T,
+                                                                         const VectorStateType& v_X,
+                                                                         VectorStateType& mole_sources,
+                                                                         VectorStateType& jvp )
+  {
+    this->compute_mole_sources_jvp( conditions, molar_densities, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                    v_T, v_X, mole_sources, jvp, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_vjp( const KC& conditions,
+                                                                         const VectorStateType& molar_densities,
+                                                                         const VectorStateType& h_RT_minus_s_R,
+                                                                         const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                         const VectorStateType& w,
+                                                                         VectorStateType& mole_sources,
+                                                                         StateType& w_dT,
+                                                                         VectorStateType& w_dX )
+  {
+    this->compute_mole_sources_vjp( conditions, molar_densities, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                    w, mole_sources, w_dT, w_dX, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mass_sources( const KC& conditions,
+                                                                     const VectorStateType& molar_densities,
+                                                                     const VectorStateType& h_RT_minus_s_R,
+                                                                     VectorStateType& mass_sources )
+  {
+    this->compute_mass_sources( conditions, molar_densities, h_RT_minus_s_R,
+                                mass_sources, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_and_derivs( const KC& conditions,
+                                                                                const VectorStateType& molar_densities,
+                                                                                const VectorStateType& h_RT_minus_s_R,
+                                                                                const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                                VectorStateType& mole_sources,
+                                                                                VectorStateType& dmole_dT,
+                                                                                std::vector<VectorStateType>& dmole_dX_s )
+  {
+    this->compute_mole_sources_and_derivs( conditions, molar_densities, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                           mole_sources, dmole_dT, dmole_dX_s, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_and_sparse_derivs( const KC& conditions,
+                                                                                       const VectorStateType& molar_densities,
+                                                                                       const VectorStateType& h_RT_minus_s_R,
+                                                                                       const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                                       VectorStateType& mole_sources,
+                                                                                       VectorStateType& dmole_dT,
+                                                                                       VectorStateType& dmole_dX_s_nonzeros )
+  {
+    this->compute_mole_sources_and_sparse_derivs( conditions, molar_densities, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                  mole_sources, dmole_dT, dmole_dX_s_nonzeros, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mass_sources_and_derivs( const KC& conditions,
+                                                                                const VectorStateType& molar_densities,
+                                                                                const VectorStateType& h_RT_minus_s_R,
+                                                                                const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                                VectorStateType& mass_sources,
+                                                                                VectorStateType& dmass_dT,
+                                                                                std::vector<VectorStateType>& dmass_drho_s )
+  {
+    this->compute_mass_sources_and_derivs( conditions, molar_densities, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                           mass_sources, dmass_dT, dmass_drho_s, _workspace );
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources( const KC& conditions,
+                                                                     const VectorStateType& molar_densities,
+                                                                     const VectorStateType& h_RT_minus_s_R,
+                                                                     VectorStateType& mole_sources,
+                                                                    KineticsWorkspace<StateType>& workspace ) const
   {
     //! \todo Make these assertions vector-compatible
     // antioch_assert_greater(T, 0.0);
     antioch_assert_equal_to( molar_densities.size(), this->n_species() );
     antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
     antioch_assert_equal_to( mole_sources.size(), this->n_species() );
+    antioch_assert_equal_to( workspace.net_reaction_rates.size(), this->n_reactions() );
 
     /*! \todo Do we need to really initialize this? */
-    Antioch::set_zero(_net_reaction_rates);
+    Antioch::set_zero(workspace.net_reaction_rates);
 
     Antioch::set_zero(mole_sources);
 
     typename constructor_or_reference<const KineticsConditions<StateType,VectorStateType>, const KC>::type  //either (KineticsConditions<> &) or (KineticsConditions<>)
                 kinetics_conditions(conditions);
     // compute the requisite reaction rates
-    this->_reaction_set.compute_reaction_rates( kinetics_conditions, molar_densities,
-                                                h_RT_minus_s_R, _net_reaction_rates );
+    if( _compiled_set )
+      _compiled_set->compute_reaction_rates( kinetics_conditions, molar_densities,
+                                             h_RT_minus_s_R, workspace.net_reaction_rates,
+                                             workspace );
+    else
+      this->_reaction_set.compute_reaction_rates( kinetics_conditions, molar_densities,
+                                                  h_RT_minus_s_R, workspace.net_reaction_rates );
 
     // compute the actual mole sources in kmol/sec/m^3
-    for (unsigned int rxn = 0; rxn < this->n_reactions(); rxn++)
-      {
-        const Reaction<CoeffType>& reaction = this->_reaction_set.reaction(rxn);
-        const StateType rate = _net_reaction_rates[rxn];
-
-        // We'd *like* to assert that our rates aren't NaN, but if we
-        // have two infinitely-stiff reactions contributing in
-        // opposite directions to the same rate, then NaN is the
-        // correct output, and hopefully our user code has some way to
-        // recover from that.
-//        antioch_assert(!has_nan(rate));
-        
-        // reactant contributions
-        for (unsigned int r = 0; r < reaction.n_reactants(); r++)
-          {
-            const unsigned int r_id = reaction.reactant_id(r);
-            const unsigned int r_stoich = reaction.reactant_stoichiometric_coefficient(r);
-            
-            mole_sources[r_id] -= (static_cast<CoeffType>(r_stoich)*rate);
-          }
-        
-        // product contributions
-        for (unsigned int p=0; p < reaction.n_products(); p++)
-          {
-            const unsigned int p_id = reaction.product_id(p);
-            const unsigned int p_stoich = reaction.product_stoichiometric_coefficient(p);
-            
-            mole_sources[p_id] += (static_cast<CoeffType>(p_stoich)*rate);
-          }
-      }
+    //
+    // We'd *like* to assert that our rates aren't NaN, but if we
+    // have two infinitely-stiff reactions contributing in
+    // opposite directions to the same rate, then NaN is the
+    // correct output, and hopefully our user code has some way to
+    // recover from that.
+    _stoichiometry.multiply( workspace.net_reaction_rates, mole_sources );
 
     return;
   }
@@ -241,10 +637,11 @@ namespace Antioch
   void KineticsEvaluator<CoeffType,StateType>::compute_mass_sources( const KC& conditions,
                                                                      const VectorStateType& molar_densities,
                                                                      const VectorStateType& h_RT_minus_s_R,
-                                                                     VectorStateType& mass_sources )
+                                                                     VectorStateType& mass_sources,
+                                                                    KineticsWorkspace<StateType>& workspace ) const
   {
     // Quantities asserted in compute_mole_sources call
-    this->compute_mole_sources( conditions, molar_densities, h_RT_minus_s_R, mass_sources );
+    this->compute_mole_sources( conditions, molar_densities, h_RT_minus_s_R, mass_sources, workspace );
 
     // finally scale by molar mass
     for (unsigned int s=0; s < this->n_species(); s++)
@@ -264,7 +661,8 @@ namespace Antioch
                                                                                 const VectorStateType& dh_RT_minus_s_R_dT,
                                                                                 VectorStateType& mole_sources,
                                                                                 VectorStateType& dmole_dT,
-                                                                                std::vector<VectorStateType>& dmole_dX_s )
+                                                                                std::vector<VectorStateType>& dmole_dX_s,
+                                                                               KineticsWorkspace<StateType>& workspace ) const
   {
     //! \todo Make these assertions vector-compatible
     // antioch_assert_greater(T, 0.0);
@@ -274,6 +672,7 @@ namespace Antioch
     antioch_assert_equal_to( mole_sources.size(), this->n_species() );
     antioch_assert_equal_to( dmole_dT.size(), this->n_species() );
     antioch_assert_equal_to( dmole_dX_s.size(), this->n_species() );
+    antioch_assert_equal_to( workspace.dnet_rate_dX_s.size(), this->n_reactions() );
 #ifdef NDEBUG
 #else
     for (unsigned int s=0; s < this->n_species(); s++)
@@ -283,8 +682,8 @@ namespace Antioch
 #endif
     
     /*! \todo Do we need to really initialize these? */
-    Antioch::set_zero(_net_reaction_rates);
-    Antioch::set_zero(_dnet_rate_dT);
+    Antioch::set_zero(workspace.net_reaction_rates);
+    Antioch::set_zero(workspace.dnet_rate_dT);
 
     Antioch::set_zero(mole_sources);
     Antioch::set_zero(dmole_dT);
@@ -296,69 +695,97 @@ namespace Antioch
     for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
       {
         /*! \todo Do we need to really initialize this? */
-        Antioch::set_zero(_dnet_rate_dX_s[rxn]);
+        Antioch::set_zero(workspace.dnet_rate_dX_s[rxn]);
       }
 
     typename constructor_or_reference<const KineticsConditions<StateType,VectorStateType>, const KC>::type  //either (KineticsConditions<> &) or (KineticsConditions<>)
                                         kinetics_conditions(conditions);
     // compute the requisite reaction rates
-    this->_reaction_set.compute_reaction_rates_and_derivs( kinetics_conditions, molar_densities, 
-                                                           h_RT_minus_s_R, dh_RT_minus_s_R_dT,
-                                                           _net_reaction_rates,
-                                                           _dnet_rate_dT, 
-                                                           _dnet_rate_dX_s );
+    if( _compiled_set )
+      _compiled_set->compute_reaction_rates_and_derivs( kinetics_conditions, molar_densities,
+                                                        h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                        workspace.net_reaction_rates,
+                                                        workspace.dnet_rate_dT,
+                                                        workspace.dnet_rate_dX_s,
+                                                        workspace );
+    else
+      this->_reaction_set.compute_reaction_rates_and_derivs( kinetics_conditions, molar_densities, 
+                                                             h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                             workspace.net_reaction_rates,
+                                                             workspace.dnet_rate_dT, 
+                                                             workspace.dnet_rate_dX_s,
+                                                             workspace );
     // compute the actual mole sources in kmol/sec/m^3
-    for (unsigned int rxn = 0; rxn < this->n_reactions(); rxn++)
-      {
+    _stoichiometry.multiply( workspace.net_reaction_rates, mole_sources );
 
-        const Reaction<CoeffType>& reaction = this->_reaction_set.reaction(rxn);
+    // d/dT rate contributions
+    _stoichiometry.multiply( workspace.dnet_rate_dT, dmole_dT );
 
-        /*! \todo Are these going to get optimized out? Should we remove them? */
-        const StateType rate = _net_reaction_rates[rxn];
-        const StateType drate_dT = _dnet_rate_dT[rxn];
-        const VectorStateType drate_dX_s = _dnet_rate_dX_s[rxn];
+    // d(.m)/dX_s rate contributions
+    _stoichiometry.multiply_matrix( workspace.dnet_rate_dX_s, dmole_dX_s );
 
-        // reactant contributions
-        for (unsigned int r = 0; r < reaction.n_reactants(); r++)
-          {
-            const unsigned int r_id = reaction.reactant_id(r);
-            const unsigned int r_stoich = reaction.reactant_stoichiometric_coefficient(r);
-            
-            mole_sources[r_id] -= (static_cast<CoeffType>(r_stoich)*rate);
+    return;
+  }
 
-            // d/dT rate contributions
-            dmole_dT[r_id] -= (static_cast<CoeffType>(r_stoich)*drate_dT);
 
-            // d(.m)/dX_s rate contributions
-            for (unsigned int s=0; s < this->n_species(); s++)
-              {
-                dmole_dX_s[r_id][s] -= (static_cast<CoeffType>(r_stoich)*drate_dX_s[s]);
-              }
-          }
-        
-        // product contributions
-        for (unsigned int p=0; p < reaction.n_products(); p++)
-          {
-            const unsigned int p_id = reaction.product_id(p);
-            const unsigned int p_stoich = reaction.product_stoichiometric_coefficient(p);
-            
-            mole_sources[p_id] += (static_cast<CoeffType>(p_stoich)*rate);
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_and_sparse_derivs( const KC& conditions,
+                                                                                       const VectorStateType& molar_densities,
+                                                                                       const VectorStateType& h_RT_minus_s_R,
+                                                                                       const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                                       VectorStateType& mole_sources,
+                                                                                       VectorStateType& dmole_dT,
+                                                                                       VectorStateType& dmole_dX_s_nonzeros,
+                                                                                      KineticsWorkspace<StateType>& workspace ) const
+  {
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+    antioch_assert_equal_to( dh_RT_minus_s_R_dT.size(), this->n_species() );
+    antioch_assert_equal_to( mole_sources.size(), this->n_species() );
+    antioch_assert_equal_to( dmole_dT.size(), this->n_species() );
+    antioch_assert_equal_to( dmole_dX_s_nonzeros.size(), _jacobian_pattern.n_nonzeros() );
+    antioch_assert_equal_to( workspace.dnet_rate_dX_s.size(), this->n_reactions() );
 
-            // d/dT rate contributions
-            dmole_dT[p_id] += (static_cast<CoeffType>(p_stoich)*drate_dT);
+    Antioch::set_zero(workspace.net_reaction_rates);
+    Antioch::set_zero(workspace.dnet_rate_dT);
 
-            // d/dX_s rate contributions
-            for (unsigned int s=0; s < this->n_species(); s++)
-              {
-                dmole_dX_s[p_id][s] += (static_cast<CoeffType>(p_stoich)*drate_dX_s[s]);
-              }
-          }
+    for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+      {
+        Antioch::set_zero(workspace.dnet_rate_dX_s[rxn]);
       }
 
+    typename constructor_or_reference<const KineticsConditions<StateType,VectorStateType>, const KC>::type  //either (KineticsConditions<> &) or (KineticsConditions<>)
+                                        kinetics_conditions(conditions);
+    // compute the requisite reaction rates
+    if( _compiled_set )
+      _compiled_set->compute_reaction_rates_and_derivs( kinetics_conditions, molar_densities,
+                                                        h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                        workspace.net_reaction_rates,
+                                                        workspace.dnet_rate_dT,
+                                                        workspace.dnet_rate_dX_s,
+                                                        workspace );
+    else
+      this->_reaction_set.compute_reaction_rates_and_derivs( kinetics_conditions, molar_densities,
+                                                             h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                             workspace.net_reaction_rates,
+                                                             workspace.dnet_rate_dT,
+                                                             workspace.dnet_rate_dX_s,
+                                                             workspace );
+
+    // compute the actual mole sources in kmol/sec/m^3
+    _stoichiometry.multiply( workspace.net_reaction_rates, mole_sources );
+
+    // d/dT rate contributions
+    _stoichiometry.multiply( workspace.dnet_rate_dT, dmole_dT );
+
+    // d(.m)/dX_s rate contributions, nonzeros only
+    _jacobian_pattern.scatter( workspace.dnet_rate_dX_s, dmole_dX_s_nonzeros );
+
     return;
   }
 
-
   template<typename CoeffType, typename StateType>
   template <typename VectorStateType, typename KC>
   inline
@@ -368,11 +795,12 @@ namespace Antioch
                                                                                 const VectorStateType& dh_RT_minus_s_R_dT,
                                                                                 VectorStateType& mass_sources,
                                                                                 VectorStateType& dmass_dT,
-                                                                                std::vector<VectorStateType>& dmass_drho_s )
+                                                                                std::vector<VectorStateType>& dmass_drho_s,
+                                                                               KineticsWorkspace<StateType>& workspace ) const
   {
     // Asserts are in compute_mole_sources
     this->compute_mole_sources_and_derivs( conditions, molar_densities, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
-                                           mass_sources, dmass_dT, dmass_drho_s );
+                                           mass_sources, dmass_dT, dmass_drho_s, workspace );
     
     // Convert from mole units to mass units
     for (unsigned int s=0; s < this->n_species(); s++)
@@ -390,6 +818,243 @@ namespace Antioch
     return;
   }
 
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_sensitivities( const KC& conditions,
+                                                                                   const VectorStateType& molar_densities,
+                                                                                   const VectorStateType& h_RT_minus_s_R,
+                                                                                   VectorStateType& mole_sources,
+                                                                                   VectorStateType& dmole_dlnA,
+                                                                                   VectorStateType& dmole_dEa,
+                                                                                   KineticsWorkspace<StateType>& workspace ) const
+  {
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+    antioch_assert_equal_to( mole_sources.size(), this->n_species() );
+    antioch_assert_equal_to( dmole_dlnA.size(), this->n_sensitivity_nonzeros() );
+    antioch_assert_equal_to( dmole_dEa.size(), this->n_sensitivity_nonzeros() );
+
+    typename constructor_or_reference<const KineticsConditions<StateType,VectorStateType>, const KC>::type  //either (KineticsConditions<> &) or (KineticsConditions<>)
+                kinetics_conditions(conditions);
+
+    this->_reaction_set.compute_rate_of_progress_sensitivities( kinetics_conditions, molar_densities, h_RT_minus_s_R,
+                                                                workspace.net_reaction_rates,
+                                                                workspace.dnet_rate_dlnA, workspace.dnet_rate_dEa,
+                                                                workspace );
+
+    _stoichiometry.multiply( workspace.net_reaction_rates, mole_sources );
+
+    // the derivatives of a rate constant of the reaction r scatter
+    // like the rate of progress of r, along the column r
+    const std::vector<unsigned int>& offsets = _stoichiometry.column_offsets();
+    const std::vector<CoeffType>& coefficients = _stoichiometry.column_coefficients();
+
+    unsigned int i(0), n(0);
+    for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+      for (unsigned int ir=0; ir < _reaction_set.reaction(rxn).n_rate_constants(); ir++, i++)
+        for (unsigned int c = offsets[rxn]; c < offsets[rxn+1]; c++, n++)
+          {
+            dmole_dlnA[n] = coefficients[c] * workspace.dnet_rate_dlnA[i];
+            dmole_dEa[n]  = coefficients[c] * workspace.dnet_rate_dEa[i];
+          }
+
+    return;
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_jvp( const KC& conditions,
+                                                                         const VectorStateType& molar_densities,
+                                                                         const VectorStateType& h_RT_minus_s_R,
+                                                                         const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                         const StateType& v_T,
+                                                                         const VectorStateType& v_X,
+                                                                         VectorStateType& mole_sources,
+                                                                         VectorStateType& jvp,
+                                                                         KineticsWorkspace<StateType>& workspace ) const
+  {
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+    antioch_assert_equal_to( dh_RT_minus_s_R_dT.size(), this->n_species() );
+    antioch_assert_equal_to( v_X.size(), this->n_species() );
+    antioch_assert_equal_to( mole_sources.size(), this->n_species() );
+    antioch_assert_equal_to( jvp.size(), this->n_species() );
+
+    typename constructor_or_reference<const KineticsConditions<StateType,VectorStateType>, const KC>::type  //either (KineticsConditions<> &) or (KineticsConditions<>)
+                kinetics_conditions(conditions);
+
+    if( _compiled_set )
+      _compiled_set->compute_reaction_rates_jvp( kinetics_conditions, molar_densities,
+                                                 h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                 v_T, v_X,
+                                                 workspace.net_reaction_rates,
+                                                 workspace.net_rate_direction,
+                                                 workspace );
+    else
+      {
+        // no directional evaluation in the ReactionSet: contract the dense derivatives
+        Antioch::set_zero(workspace.net_reaction_rates);
+        Antioch::set_zero(workspace.dnet_rate_dT);
+        for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+          Antioch::set_zero(workspace.dnet_rate_dX_s[rxn]);
+
+        this->_reaction_set.compute_reaction_rates_and_derivs( kinetics_conditions, molar_densities,
+                                                               h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                               workspace.net_reaction_rates,
+                                                               workspace.dnet_rate_dT,
+                                                               workspace.dnet_rate_dX_s,
+                                                               workspace );
+
+        for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+          {
+            workspace.net_rate_direction[rxn] = workspace.dnet_rate_dT[rxn] * v_T;
+            for (unsigned int s=0; s < this->n_species(); s++)
+              workspace.net_rate_direction[rxn] += workspace.dnet_rate_dX_s[rxn][s] * v_X[s];
+          }
+      }
+
+    _stoichiometry.multiply( workspace.net_reaction_rates, mole_sources );
+    _stoichiometry.multiply( workspace.net_rate_direction, jvp );
+
+    return;
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_vjp( const KC& conditions,
+                                                                         const VectorStateType& molar_densities,
+                                                                         const VectorStateType& h_RT_minus_s_R,
+                                                                         const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                         const VectorStateType& w,
+                                                                         VectorStateType& mole_sources,
+                                                                         StateType& w_dT,
+                                                                         VectorStateType& w_dX,
+                                                                         KineticsWorkspace<StateType>& workspace ) const
+  {
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+    antioch_assert_equal_to( dh_RT_minus_s_R_dT.size(), this->n_species() );
+    antioch_assert_equal_to( w.size(), this->n_species() );
+    antioch_assert_equal_to( mole_sources.size(), this->n_species() );
+    antioch_assert_equal_to( w_dX.size(), this->n_species() );
+
+    typename constructor_or_reference<const KineticsConditions<StateType,VectorStateType>, const KC>::type  //either (KineticsConditions<> &) or (KineticsConditions<>)
+                kinetics_conditions(conditions);
+
+    // weights of the rates of progress
+    _stoichiometry.transpose_multiply( w, workspace.net_rate_direction );
+
+    if( _compiled_set )
+      _compiled_set->compute_reaction_rates_vjp( kinetics_conditions, molar_densities,
+                                                 h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                 workspace.net_rate_direction,
+                                                 workspace.net_reaction_rates,
+                                                 w_dT, w_dX,
+                                                 workspace );
+    else
+      {
+        Antioch::set_zero(workspace.net_reaction_rates);
+        Antioch::set_zero(workspace.dnet_rate_dT);
+        for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+          Antioch::set_zero(workspace.dnet_rate_dX_s[rxn]);
+
+        this->_reaction_set.compute_reaction_rates_and_derivs( kinetics_conditions, molar_densities,
+                                                               h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                               workspace.net_reaction_rates,
+                                                               workspace.dnet_rate_dT,
+                                                               workspace.dnet_rate_dX_s,
+                                                               workspace );
+
+        w_dT = Antioch::zero_clone(kinetics_conditions.T());
+        Antioch::set_zero(w_dX);
+        for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+          {
+            w_dT += workspace.net_rate_direction[rxn] * workspace.dnet_rate_dT[rxn];
+            for (unsigned int s=0; s < this->n_species(); s++)
+              w_dX[s] += workspace.net_rate_direction[rxn] * workspace.dnet_rate_dX_s[rxn][s];
+          }
+      }
+
+    _stoichiometry.multiply( workspace.net_reaction_rates, mole_sources );
+
+    return;
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources( const KC& conditions,
+                                                                     const VectorStateType& molar_densities,
+                                                                     const VectorStateType& h_RT_minus_s_R,
+                                                                     const ActiveReactions<CoeffType>& active,
+                                                                     VectorStateType& mole_sources,
+                                                                     KineticsWorkspace<StateType>& workspace ) const
+  {
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+    antioch_assert_equal_to( mole_sources.size(), this->n_species() );
+    antioch_assert_equal_to( active.n_reactions(), this->n_reactions() );
+
+    typename constructor_or_reference<const KineticsConditions<StateType,VectorStateType>, const KC>::type  //either (KineticsConditions<> &) or (KineticsConditions<>)
+                kinetics_conditions(conditions);
+
+    Antioch::set_zero(workspace.net_reaction_rates);
+
+    this->_reaction_set.compute_reaction_rates( kinetics_conditions, molar_densities, h_RT_minus_s_R,
+                                                active.active_reactions(),
+                                                workspace.net_reaction_rates,
+                                                workspace );
+
+    _stoichiometry.multiply( workspace.net_reaction_rates, mole_sources );
+
+    return;
+  }
+
+  template<typename CoeffType, typename StateType>
+  template<typename VectorStateType, typename KC>
+  inline
+  void KineticsEvaluator<CoeffType,StateType>::compute_mole_sources_mask_error( const KC& conditions,
+                                                                                const VectorStateType& molar_densities,
+                                                                                const VectorStateType& h_RT_minus_s_R,
+                                                                                const ActiveReactions<CoeffType>& active,
+                                                                                VectorStateType& error_bound,
+                                                                                KineticsWorkspace<StateType>& workspace ) const
+  {
+    using std::abs;
+
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+    antioch_assert_equal_to( error_bound.size(), this->n_species() );
+    antioch_assert_equal_to( active.n_reactions(), this->n_reactions() );
+
+    typename constructor_or_reference<const KineticsConditions<StateType,VectorStateType>, const KC>::type  //either (KineticsConditions<> &) or (KineticsConditions<>)
+                kinetics_conditions(conditions);
+
+    const std::vector<unsigned int>& inactive = active.inactive_reactions();
+
+    this->_reaction_set.compute_reaction_rates( kinetics_conditions, molar_densities, h_RT_minus_s_R,
+                                                inactive,
+                                                workspace.net_reaction_rates,
+                                                workspace );
+
+    const std::vector<unsigned int>& offsets = _stoichiometry.column_offsets();
+    const std::vector<unsigned int>& species = _stoichiometry.column_species();
+    const std::vector<CoeffType>& coefficients = _stoichiometry.column_coefficients();
+
+    Antioch::set_zero(error_bound);
+    for (unsigned int i=0; i < inactive.size(); i++)
+      {
+        const unsigned int rxn = inactive[i];
+        for (unsigned int c = offsets[rxn]; c < offsets[rxn+1]; c++)
+          error_bound[species[c]] += abs(coefficients[c] * workspace.net_reaction_rates[rxn]);
+      }
+
+    return;
+  }
+
 } // end namespace Antioch
 
 #endif // ANTIOCH_KINETICS_EVALUATOR_H
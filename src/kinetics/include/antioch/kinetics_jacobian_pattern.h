@@ -0,0 +1,320 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_KINETICS_JACOBIAN_PATTERN_H
+#define ANTIOCH_KINETICS_JACOBIAN_PATTERN_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/metaprogramming.h"
+#include "antioch/reaction_set.h"
+#include "antioch/stoichiometric_matrix.h"
+
+// C++
+#include <vector>
+#include <algorithm>
+
+namespace Antioch
+{
+
+  //! Structural sparsity of the species source terms Jacobian
+  /*!\class KineticsJacobianPattern
+   *
+   * The derivative of the molar source of species \f$s\f$ with respect to
+   * the molar density of species \f$t\f$ is
+   * \f[
+   *   \frac{\partial \dot{\omega}_s}{\partial c_t} = \sum_r \nu_{s,r} \frac{\partial R_r}{\partial c_t}
+   * \f]
+   * and \f$\frac{\partial R_r}{\partial c_t}\f$ is nonzero only if \f$t\f$ is
+   * a reactant of \f$r\f$, a product of \f$r\f$ if \f$r\f$ is reversible, or
+   * a collision partner (nonzero efficiency) of \f$r\f$ if \f$r\f$ is
+   * a three-body or falloff reaction.
+   *
+   * This class computes once the resulting n_species \f$\times\f$ n_species
+   * pattern in CSR form (sorted column indices, diagonal always stored)
+   * and the positions needed to scatter the reaction rate derivatives
+   * directly into the nonzero values.
+   */
+  template<typename CoeffType=double>
+  class KineticsJacobianPattern
+  {
+  public:
+
+    //! Constructor, builds the pattern from the reaction set.
+    KineticsJacobianPattern( const ReactionSet<CoeffType>& reaction_set,
+                             const StoichiometricMatrix<CoeffType>& stoichiometry );
+
+    ~KineticsJacobianPattern();
+
+    //! \returns the number of species (rows and columns).
+    unsigned int n_species() const;
+
+    //! \returns the number of structurally nonzero entries.
+    unsigned int n_nonzeros() const;
+
+    //! CSR: entries of row s are in [row_offsets()[s],row_offsets()[s+1])
+    const std::vector<unsigned int>& row_offsets() const;
+
+    //! CSR: column of each entry
+    const std::vector<unsigned int>& column_indices() const;
+
+    //! \returns the position of entry (s,t) in the values array, n_nonzeros() if
+    //  it is not in the pattern.
+    unsigned int position( const unsigned int s, const unsigned int t ) const;
+
+    //! species whose molar density the rate of progress of reaction \p rxn depends on
+    //  are in [reaction_offsets()[rxn],reaction_offsets()[rxn+1])
+    const std::vector<unsigned int>& reaction_offsets() const;
+
+    const std::vector<unsigned int>& reaction_dependencies() const;
+
+    //! \f$J_{s,t} = \sum_r \nu_{s,r} \frac{\partial R_r}{\partial c_t}\f$, nonzeros only
+    /*!
+     * \p drates_dX is a n_reactions \f$\times\f$ n_species matrix,
+     * \p values has n_nonzeros() entries and is overwritten.
+     */
+    template <typename MatrixReactionsType, typename VectorValuesType>
+    void scatter( const MatrixReactionsType& drates_dX,
+                  VectorValuesType& values ) const;
+
+  protected:
+
+    unsigned int _n_species;
+
+    unsigned int _n_reactions;
+
+    //! copy of the stoichiometric columns (CSC)
+    std::vector<unsigned int> _stoichiometry_offsets;
+    std::vector<CoeffType>    _stoichiometry_coefficients;
+
+    std::vector<unsigned int> _row_offsets;
+    std::vector<unsigned int> _column_indices;
+
+    std::vector<unsigned int> _reaction_offsets;
+    std::vector<unsigned int> _reaction_dependencies;
+
+    //! for each reaction, each stored coefficient of its stoichiometric
+    //  column and each dependency, the position in the values array
+    std::vector<unsigned int> _scatter_positions;
+
+  private:
+
+    KineticsJacobianPattern();
+
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType>
+  inline
+  KineticsJacobianPattern<CoeffType>::KineticsJacobianPattern( const ReactionSet<CoeffType>& reaction_set,
+                                                               const StoichiometricMatrix<CoeffType>& stoichiometry )
+    : _n_species(reaction_set.n_species()),
+      _n_reactions(reaction_set.n_reactions()),
+      _stoichiometry_offsets(stoichiometry.column_offsets()),
+      _stoichiometry_coefficients(stoichiometry.column_coefficients())
+  {
+    antioch_assert_equal_to(stoichiometry.n_reactions(), reaction_set.n_reactions());
+
+    // dependencies of each reaction
+    _reaction_offsets.assign(1,0);
+    std::vector<bool> depends(_n_species);
+    for(unsigned int rxn = 0; rxn < reaction_set.n_reactions(); rxn++)
+      {
+        const Reaction<CoeffType>& reaction = reaction_set.reaction(rxn);
+        std::fill(depends.begin(),depends.end(),false);
+
+        for(unsigned int r = 0; r < reaction.n_reactants(); r++)
+          depends[reaction.reactant_id(r)] = true;
+
+        if(reaction.reversible())
+          for(unsigned int p = 0; p < reaction.n_products(); p++)
+            depends[reaction.product_id(p)] = true;
+
+        switch(reaction.type())
+          {
+          case(ReactionType::THREE_BODY):
+          case(ReactionType::LINDEMANN_FALLOFF_THREE_BODY):
+          case(ReactionType::TROE_FALLOFF_THREE_BODY):
+            {
+              for(unsigned int s = 0; s < _n_species; s++)
+                if(reaction.efficiency(s) != 0)
+                  depends[s] = true;
+            }
+            break;
+
+          case(ReactionType::LINDEMANN_FALLOFF):
+          case(ReactionType::TROE_FALLOFF):
+            {
+              std::fill(depends.begin(),depends.end(),true);
+            }
+            break;
+
+          default: // the others do not depend on [M]
+            break;
+          }
+
+        for(unsigned int s = 0; s < _n_species; s++)
+          if(depends[s])
+            _reaction_dependencies.push_back(s);
+
+        _reaction_offsets.push_back(_reaction_dependencies.size());
+      }
+
+    // pattern, row by row
+    const std::vector<unsigned int>& row_offsets = stoichiometry.row_offsets();
+    const std::vector<unsigned int>& row_reactions = stoichiometry.row_reactions();
+
+    _row_offsets.assign(1,0);
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        std::fill(depends.begin(),depends.end(),false);
+        depends[s] = true;
+
+        for(unsigned int i = row_offsets[s]; i < row_offsets[s+1]; i++)
+          {
+            const unsigned int rxn = row_reactions[i];
+            for(unsigned int j = _reaction_offsets[rxn]; j < _reaction_offsets[rxn+1]; j++)
+              depends[_reaction_dependencies[j]] = true;
+          }
+
+        for(unsigned int t = 0; t < _n_species; t++)
+          if(depends[t])
+            _column_indices.push_back(t);
+
+        _row_offsets.push_back(_column_indices.size());
+      }
+
+    // scatter positions, reaction by reaction
+    const std::vector<unsigned int>& column_offsets = stoichiometry.column_offsets();
+    const std::vector<unsigned int>& column_species = stoichiometry.column_species();
+    for(unsigned int rxn = 0; rxn < reaction_set.n_reactions(); rxn++)
+      {
+        for(unsigned int i = column_offsets[rxn]; i < column_offsets[rxn+1]; i++)
+          {
+            for(unsigned int j = _reaction_offsets[rxn]; j < _reaction_offsets[rxn+1]; j++)
+              {
+                _scatter_positions.push_back(this->position(column_species[i],_reaction_dependencies[j]));
+                antioch_assert_less(_scatter_positions.back(),this->n_nonzeros());
+              }
+          }
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  KineticsJacobianPattern<CoeffType>::~KineticsJacobianPattern()
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int KineticsJacobianPattern<CoeffType>::n_species() const
+  {
+    return _n_species;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int KineticsJacobianPattern<CoeffType>::n_nonzeros() const
+  {
+    return _column_indices.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& KineticsJacobianPattern<CoeffType>::row_offsets() const
+  {
+    return _row_offsets;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& KineticsJacobianPattern<CoeffType>::column_indices() const
+  {
+    return _column_indices;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& KineticsJacobianPattern<CoeffType>::reaction_offsets() const
+  {
+    return _reaction_offsets;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& KineticsJacobianPattern<CoeffType>::reaction_dependencies() const
+  {
+    return _reaction_dependencies;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int KineticsJacobianPattern<CoeffType>::position( const unsigned int s, const unsigned int t ) const
+  {
+    antioch_assert_less(s,_n_species);
+
+    const std::vector<unsigned int>::const_iterator begin = _column_indices.begin() + _row_offsets[s];
+    const std::vector<unsigned int>::const_iterator end   = _column_indices.begin() + _row_offsets[s+1];
+    const std::vector<unsigned int>::const_iterator it    = std::lower_bound(begin,end,t);
+
+    return (it != end && *it == t)?(it - _column_indices.begin()):this->n_nonzeros();
+  }
+
+  template<typename CoeffType>
+  template <typename MatrixReactionsType, typename VectorValuesType>
+  inline
+  void KineticsJacobianPattern<CoeffType>::scatter( const MatrixReactionsType& drates_dX,
+                                                    VectorValuesType& values ) const
+  {
+    antioch_assert_equal_to( drates_dX.size(), _n_reactions );
+    antioch_assert_equal_to( values.size(), this->n_nonzeros() );
+
+    for(unsigned int n = 0; n < this->n_nonzeros(); n++)
+      Antioch::set_zero(values[n]);
+
+    unsigned int pos = 0;
+    for(unsigned int rxn = 0; rxn < _n_reactions; rxn++)
+      {
+        for(unsigned int i = _stoichiometry_offsets[rxn]; i < _stoichiometry_offsets[rxn+1]; i++)
+          {
+            const CoeffType nu = _stoichiometry_coefficients[i];
+            for(unsigned int j = _reaction_offsets[rxn]; j < _reaction_offsets[rxn+1]; j++)
+              {
+                values[_scatter_positions[pos++]] += nu * drates_dX[rxn][_reaction_dependencies[j]];
+              }
+          }
+      }
+
+    return;
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_KINETICS_JACOBIAN_PATTERN_H
@@ -75,6 +75,26 @@ namespace Antioch
                                KineticsModel::Parameters parameter,
                                const CoeffType new_value, int l, const std::string & unit = "SI");
 
+  //! factor from \p unit to the internal unit of \p parameter
+  /*!
+   * This is the translation done by reset_parameter_of_rate(),
+   * the activation energy included.
+   */
+  template <typename CoeffType>
+  CoeffType rate_parameter_unit_factor(KineticsModel::Parameters parameter, const std::string & unit = "SI");
+
+  //! reset a parameter given in the internal unit, no unit management
+  template <typename CoeffType, typename VectorCoeffType>
+  void set_internal_parameter_of_rate(KineticsType<CoeffType,VectorCoeffType> & rate,
+                                      KineticsModel::Parameters parameter,
+                                      const CoeffType new_coef);
+
+  // vectorized parameter
+  template <typename CoeffType, typename VectorCoeffType>
+  void set_internal_parameter_of_rate(KineticsType<CoeffType,VectorCoeffType> & rate,
+                                      KineticsModel::Parameters parameter,
+                                      const CoeffType new_coef, int l);
+
 
 //----------------------------------------
 
@@ -254,8 +274,28 @@ namespace Antioch
          new_coef = new_coef / Constants::R_universal<typename value_type<CoeffType>::type>();
       }
    }
-   
 
+    set_internal_parameter_of_rate(rate, parameter, new_coef);
+  }
+
+  template <typename CoeffType>
+  CoeffType rate_parameter_unit_factor(KineticsModel::Parameters parameter, const std::string & unit)
+  {
+    CoeffType factor(1);
+    if(unit != "SI")
+      factor = Units<typename value_type<CoeffType>::type>(unit).get_SI_factor();
+
+    if(parameter == KineticsModel::Parameters::E && unit != "K")
+      factor = factor / Constants::R_universal<typename value_type<CoeffType>::type>();
+
+    return factor;
+  }
+
+  template <typename CoeffType, typename VectorCoeffType>
+  void set_internal_parameter_of_rate(KineticsType<CoeffType,VectorCoeffType> & rate,
+                                      KineticsModel::Parameters parameter,
+                                      const CoeffType new_coef)
+  {
     switch(rate.type())
       {
       case(KineticsModel::CONSTANT):
@@ -321,6 +361,14 @@ namespace Antioch
     CoeffType new_coef = (unit == "SI")?new_value:
                                         new_value * Units<typename value_type<CoeffType>::type>(unit).get_SI_factor();
 
+    set_internal_parameter_of_rate(rate, parameter, new_coef, l);
+  }
+
+  template <typename CoeffType, typename VectorCoeffType>
+  void set_internal_parameter_of_rate(KineticsType<CoeffType,VectorCoeffType> & rate,
+                                      KineticsModel::Parameters parameter,
+                                      const CoeffType new_coef, int l)
+  {
     switch(rate.type())
     {
       case(KineticsModel::PHOTOCHEM):
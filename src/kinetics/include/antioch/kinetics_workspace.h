@@ -0,0 +1,275 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_KINETICS_WORKSPACE_H
+#define ANTIOCH_KINETICS_WORKSPACE_H
+
+// Antioch
+#include "antioch/metaprogramming.h"
+#include "antioch/reaction_enum.h"
+
+// C++
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+namespace Antioch
+{
+  // Forward declarations
+  template<typename CoeffType>
+  class ReactionSet;
+
+  //! Scratch space for the kinetics derivatives evaluations
+  /*!\class KineticsWorkspace
+   *
+   * All the work arrays needed by the ReactionSet and CompiledReactionSet
+   * evaluations and by the KineticsEvaluator,
+   * sized once from a ReactionSet.
+   * Passing a workspace to those methods guarantees that no memory is
+   * allocated during the call for scalar StateTypes (vector-valued StateTypes
+   * still create StateType temporaries).
+   *
+   * A workspace is not meant to be shared: in a threaded environment, each
+   * thread needs its own, while the mechanism and the evaluator are shared.
+   *
+   * The workspace can also keep the temperature dependent part of the
+   * CompiledReactionSet evaluations (rate constants, equilibrium
+   * constants and Troe \f$F_{\text{cent}}\f$, and their temperature
+   * derivatives) from one call to the next,
+   * see enable_temperature_cache().
+   */
+  template<typename StateType, typename VectorStateType = std::vector<StateType> >
+  class KineticsWorkspace
+  {
+  public:
+
+    //! Constructor, \p example gives the size of vector-valued StateTypes.
+    template<typename CoeffType>
+    KineticsWorkspace( const ReactionSet<CoeffType>& reaction_set,
+                       const StateType& example );
+
+    ~KineticsWorkspace();
+
+    //! Reuse the temperature dependent terms while the temperature is unchanged
+    /*! Off by default. When on, a CompiledReactionSet evaluation at exactly
+     *  the temperature of the previous one only recomputes the concentration
+     *  dependent terms. The equilibrium constants are then assumed to
+     *  depend on the temperature only, i.e. h_RT_minus_s_R to be the same
+     *  function of T from one call to the next. A workspace caching
+     *  temperatures must be used with a single CompiledReactionSet.
+     */
+    void enable_temperature_cache( bool enable = true );
+
+    //! Forget the cached temperature, e.g. if the thermodynamics changed
+    void clear_temperature_cache();
+
+    //! True if the terms of the evaluation at \p T are cached, with their
+    //  temperature derivatives if \p derivs
+    bool temperature_cache_hit( const StateType& T, bool derivs ) const;
+
+    //! Records that the terms of the evaluation at \p T were computed
+    void store_temperature( const StateType& T, bool derivs );
+
+    //! n_species: forward rate coefficient concentration derivatives
+    VectorStateType dkfwd_dX_s;
+
+    //! rate constants and their temperature derivatives (one per rate constant)
+    std::vector<StateType> k_slot;
+    std::vector<StateType> dk_slot_dT;
+
+    //! n_reactions: forward rate coefficients and derivatives
+    std::vector<StateType> kfwd;
+    std::vector<StateType> dkfwd_dT;
+    std::vector<StateType> dkfwd_dM;
+
+    //! n_reactions + 1: [M] of the distinct sets of efficiencies,
+    //  see CompiledReactionSet::n_efficiency_sets()
+    std::vector<StateType> collision_M;
+
+    //! n_reactions + 1: directional derivatives (or adjoint weights) of the
+    //  [M] of every set of efficiencies, see CompiledReactionSet::compute_reaction_rates_jvp()
+    std::vector<StateType> collision_direction;
+
+    //! Troe reactions: \f$F_{\text{cent}}\f$, its logarithm and temperature derivative,
+    //  see CompiledReactionSet
+    std::vector<StateType> troe_Fcent;
+    std::vector<StateType> troe_logFcent;
+    std::vector<StateType> troe_dFcent_dT;
+
+    //! n_rate_constants (all reactions): net rates of progress derivatives
+    //  with respect to the rate constants parameters, see
+    //  ReactionSet::compute_rate_of_progress_sensitivities()
+    std::vector<StateType> dnet_rate_dlnA;
+    std::vector<StateType> dnet_rate_dEa;
+
+    //! most rate constants in a reaction: forward rate coefficient
+    //  logarithmic sensitivities
+    std::vector<StateType> dlnkfwd_dlnk;
+
+    //! most reactants or products in a reaction: concentrations terms
+    std::vector<StateType> val;
+    std::vector<StateType> dval;
+
+    //! n_reactions: net rates of progress and derivatives
+    std::vector<StateType> net_reaction_rates;
+    std::vector<StateType> dnet_rate_dT;
+
+    //! n_reactions: net rates of progress directional derivatives, or their adjoint weights
+    std::vector<StateType> net_rate_direction;
+
+    //! n_reactions x n_species
+    std::vector<VectorStateType> dnet_rate_dX_s;
+
+    //! n_reactions: equilibrium constants and derivatives (reversible reactions only)
+    std::vector<StateType> keq;
+    std::vector<StateType> dkeq_dT;
+
+    //! n_species: species factors of the equilibrium constants, see
+    //  ReactionSet::compute_equilibrium_constants()
+    std::vector<StateType> species_exp;
+
+    //! powers of the pressure factor of the equilibrium constants,
+    //  from -max|gamma| to max|gamma|
+    std::vector<StateType> P0_RT_powers;
+
+  private:
+
+    KineticsWorkspace();
+
+    bool _cache_enabled;
+
+    //! 0: nothing cached, 1: values, 2: values and temperature derivatives
+    unsigned int _cached_level;
+
+    StateType _cached_T;
+
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename StateType, typename VectorStateType>
+  template<typename CoeffType>
+  inline
+  KineticsWorkspace<StateType,VectorStateType>::KineticsWorkspace( const ReactionSet<CoeffType>& reaction_set,
+                                                                   const StateType& example )
+    : dkfwd_dX_s( reaction_set.n_species(), example ),
+      kfwd( reaction_set.n_reactions(), example ),
+      dkfwd_dT( reaction_set.n_reactions(), example ),
+      dkfwd_dM( reaction_set.n_reactions(), example ),
+      collision_M( reaction_set.n_reactions() + 1, example ),
+      collision_direction( reaction_set.n_reactions() + 1, example ),
+      net_reaction_rates( reaction_set.n_reactions(), example ),
+      dnet_rate_dT( reaction_set.n_reactions(), example ),
+      net_rate_direction( reaction_set.n_reactions(), example ),
+      dnet_rate_dX_s( reaction_set.n_reactions(), VectorStateType(reaction_set.n_species(), example) ),
+      keq( reaction_set.n_reactions(), example ),
+      dkeq_dT( reaction_set.n_reactions(), example ),
+      species_exp( reaction_set.n_species(), example ),
+      _cache_enabled(false),
+      _cached_level(0),
+      _cached_T(example)
+  {
+    unsigned int n_rate_constants(0);
+    unsigned int max_rate_constants(0);
+    unsigned int max_participants(0);
+    unsigned int max_gamma(0);
+    unsigned int n_troe(0);
+    for(unsigned int rxn = 0; rxn < reaction_set.n_reactions(); rxn++)
+      {
+        if( reaction_set.reaction(rxn).type() == ReactionType::TROE_FALLOFF ||
+            reaction_set.reaction(rxn).type() == ReactionType::TROE_FALLOFF_THREE_BODY )
+          n_troe++;
+
+        n_rate_constants += reaction_set.reaction(rxn).n_rate_constants();
+        max_rate_constants = std::max(max_rate_constants,
+                                      reaction_set.reaction(rxn).n_rate_constants());
+        max_participants = std::max(max_participants,
+                                    std::max(reaction_set.reaction(rxn).n_reactants(),
+                                             reaction_set.reaction(rxn).n_products()));
+        max_gamma = std::max(max_gamma,
+                             static_cast<unsigned int>(std::abs(reaction_set.reaction(rxn).gamma())));
+      }
+
+    k_slot.resize(n_rate_constants, example);
+    dk_slot_dT.resize(n_rate_constants, example);
+    dnet_rate_dlnA.resize(n_rate_constants, example);
+    dnet_rate_dEa.resize(n_rate_constants, example);
+    dlnkfwd_dlnk.resize(max_rate_constants, example);
+    val.resize(max_participants, example);
+    dval.resize(max_participants, example);
+    troe_Fcent.resize(n_troe, example);
+    troe_logFcent.resize(n_troe, example);
+    troe_dFcent_dT.resize(n_troe, example);
+    P0_RT_powers.resize(2*max_gamma + 1, example);
+
+    return;
+  }
+
+  template<typename StateType, typename VectorStateType>
+  inline
+  KineticsWorkspace<StateType,VectorStateType>::~KineticsWorkspace()
+  {
+    return;
+  }
+
+  template<typename StateType, typename VectorStateType>
+  inline
+  void KineticsWorkspace<StateType,VectorStateType>::enable_temperature_cache( bool enable )
+  {
+    _cache_enabled = enable;
+    _cached_level = 0;
+  }
+
+  template<typename StateType, typename VectorStateType>
+  inline
+  void KineticsWorkspace<StateType,VectorStateType>::clear_temperature_cache()
+  {
+    _cached_level = 0;
+  }
+
+  template<typename StateType, typename VectorStateType>
+  inline
+  bool KineticsWorkspace<StateType,VectorStateType>::temperature_cache_hit( const StateType& T, bool derivs ) const
+  {
+    if( !_cache_enabled || _cached_level < (derivs ? 2 : 1) )
+      return false;
+
+    return Antioch::conjunction( T == _cached_T );
+  }
+
+  template<typename StateType, typename VectorStateType>
+  inline
+  void KineticsWorkspace<StateType,VectorStateType>::store_temperature( const StateType& T, bool derivs )
+  {
+    if( !_cache_enabled )
+      return;
+
+    _cached_T = T;
+    _cached_level = derivs ? 2 : 1;
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_KINETICS_WORKSPACE_H
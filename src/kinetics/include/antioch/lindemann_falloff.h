@@ -77,6 +77,25 @@ namespace Antioch{
                            StateType &dF_dT,
                            VectorStateType &dF_dX) const;
 
+    //! F and derivatives, concentration derivative with respect to [M]
+    template <typename StateType>
+    void F_and_derivatives(const StateType& T,
+                           const StateType &M,
+                           const StateType &k0,
+                           const StateType &dk0_dT,
+                           const StateType &kinf,
+                           const StateType &dkinf_dT,
+                           StateType &F,
+                           StateType &dF_dT,
+                           StateType &dF_dM) const;
+
+    //! \f$\frac{\partial \ln F}{\partial \ln P_r}\f$, zero here
+    template <typename StateType>
+    StateType dlogF_dlogPr(const StateType& T,
+                           const StateType &M,
+                           const StateType &k0,
+                           const StateType &kinf) const;
+
   private:
     unsigned int n_spec;
 
@@ -130,6 +149,41 @@ namespace Antioch{
     return;
   }
 
+  template <typename CoeffType>
+  template <typename StateType>
+  inline
+  void LindemannFalloff<CoeffType>::F_and_derivatives
+    (const StateType& T,
+     const StateType& /* M */,
+     const StateType& /* k0 */,
+     const StateType& /* dk0_dT */,
+     const StateType& /* kinf */,
+     const StateType& /* dkinf_dT */,
+     StateType& F,
+     StateType& dF_dT,
+     StateType& dF_dM) const
+  {
+    //all derived are 0
+    Antioch::set_zero(dF_dT);
+    Antioch::set_zero(dF_dM);
+    // F = 1
+    F = Antioch::constant_clone(T,1);
+
+    return;
+  }
+
+  template <typename CoeffType>
+  template <typename StateType>
+  inline
+  StateType LindemannFalloff<CoeffType>::dlogF_dlogPr
+    (const StateType& /* T */,
+     const StateType& M,
+     const StateType& /* k0 */,
+     const StateType& /* kinf */) const
+  {
+    return Antioch::zero_clone(M);
+  }
+
   template<typename CoeffType>
   inline
   LindemannFalloff<CoeffType>::LindemannFalloff(const unsigned int nspec):n_spec(nspec)
@@ -0,0 +1,320 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_LOG_TEMPERATURE_TABLE_H
+#define ANTIOCH_LOG_TEMPERATURE_TABLE_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/cmath_shims.h"
+
+// C++
+#include <vector>
+
+namespace Antioch
+{
+  //! Functions of \f$\ln(T)\f$ tabulated on a uniform grid
+  /*!\class LogTemperatureTable
+   *
+   * Stores the values \f$f_i\f$ and slopes \f$\frac{df_i}{d\ln(T)}\f$ of a set
+   * of functions at the nodes of a uniform \f$\ln(T)\f$ grid, and interpolates
+   * them by cubic Hermite polynomials. The values of all the functions at a
+   * node are contiguous, so that an interpolation reads two contiguous blocks.
+   *
+   * Function \f$i\f$ is written to entry positions()[i] of the output vectors,
+   * so that a table can cover some of the reactions only.
+   */
+  template<typename CoeffType=double>
+  class LogTemperatureTable
+  {
+  public:
+
+    //! Empty table
+    LogTemperatureTable();
+
+    ~LogTemperatureTable();
+
+    //! Allocates \p n_points nodes for the functions stored at \p positions
+    void resize( const CoeffType T_min, const CoeffType T_max, const unsigned int n_points,
+                 const std::vector<unsigned int>& positions );
+
+    void clear();
+
+    bool empty() const;
+
+    unsigned int n_points() const;
+
+    unsigned int n_functions() const;
+
+    CoeffType T_min() const;
+
+    CoeffType T_max() const;
+
+    //! \f$\ln(T)\f$ at node \p node
+    CoeffType lnT( const unsigned int node ) const;
+
+    const std::vector<unsigned int>& positions() const;
+
+    //! Sets the value and \f$\ln(T)\f$-slope of function \p f at node \p node
+    void set( const unsigned int node, const unsigned int f,
+              const CoeffType value, const CoeffType slope );
+
+    //! True if \p T is within the tabulated range
+    bool in_range( const CoeffType T ) const;
+
+    //! Interpolates all the functions at \p lnT.
+    template <typename StateType>
+    void interpolate( const CoeffType lnT, std::vector<StateType>& values ) const;
+
+    //! Interpolates all the functions and their \f$\ln(T)\f$-slopes at \p lnT.
+    template <typename StateType>
+    void interpolate_and_derivs( const CoeffType lnT,
+                                 std::vector<StateType>& values,
+                                 std::vector<StateType>& slopes ) const;
+
+  private:
+
+    //! interval of \p lnT and position within it
+    void locate( const CoeffType lnT, unsigned int& node, CoeffType& t ) const;
+
+    CoeffType _T_min;
+    CoeffType _T_max;
+    CoeffType _lnT_min;
+    CoeffType _dlnT;
+
+    unsigned int _n_points;
+
+    std::vector<unsigned int> _positions;
+
+    //! n_points x n_functions
+    std::vector<CoeffType> _values;
+    std::vector<CoeffType> _slopes;
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType>
+  inline
+  LogTemperatureTable<CoeffType>::LogTemperatureTable()
+    : _T_min(0),
+      _T_max(0),
+      _lnT_min(0),
+      _dlnT(0),
+      _n_points(0)
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  LogTemperatureTable<CoeffType>::~LogTemperatureTable()
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  void LogTemperatureTable<CoeffType>::resize( const CoeffType T_min, const CoeffType T_max, const unsigned int n_points,
+                                               const std::vector<unsigned int>& positions )
+  {
+    if( !(T_min > 0 && T_max > T_min) || n_points < 2 )
+      antioch_error_msg("Invalid temperature table, expected 0 < T_min < T_max and at least 2 points");
+
+    _T_min    = T_min;
+    _T_max    = T_max;
+    _lnT_min  = ant_log(T_min);
+    _dlnT     = (ant_log(T_max) - _lnT_min)/(n_points - 1);
+    _n_points = n_points;
+
+    _positions = positions;
+    _values.assign(n_points * positions.size(), 0);
+    _slopes.assign(n_points * positions.size(), 0);
+  }
+
+  template<typename CoeffType>
+  inline
+  void LogTemperatureTable<CoeffType>::clear()
+  {
+    _T_min = _T_max = _lnT_min = _dlnT = 0;
+    _n_points = 0;
+    _positions.clear();
+    _values.clear();
+    _slopes.clear();
+  }
+
+  template<typename CoeffType>
+  inline
+  bool LogTemperatureTable<CoeffType>::empty() const
+  {
+    return (_n_points == 0);
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int LogTemperatureTable<CoeffType>::n_points() const
+  {
+    return _n_points;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int LogTemperatureTable<CoeffType>::n_functions() const
+  {
+    return _positions.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType LogTemperatureTable<CoeffType>::T_min() const
+  {
+    return _T_min;
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType LogTemperatureTable<CoeffType>::T_max() const
+  {
+    return _T_max;
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType LogTemperatureTable<CoeffType>::lnT( const unsigned int node ) const
+  {
+    antioch_assert_less( node, _n_points );
+
+    return _lnT_min + node * _dlnT;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& LogTemperatureTable<CoeffType>::positions() const
+  {
+    return _positions;
+  }
+
+  template<typename CoeffType>
+  inline
+  void LogTemperatureTable<CoeffType>::set( const unsigned int node, const unsigned int f,
+                                            const CoeffType value, const CoeffType slope )
+  {
+    antioch_assert_less( node, _n_points );
+    antioch_assert_less( f, this->n_functions() );
+
+    _values[node * this->n_functions() + f] = value;
+    _slopes[node * this->n_functions() + f] = slope;
+  }
+
+  template<typename CoeffType>
+  inline
+  bool LogTemperatureTable<CoeffType>::in_range( const CoeffType T ) const
+  {
+    return (!this->empty() && T >= _T_min && T <= _T_max);
+  }
+
+  template<typename CoeffType>
+  inline
+  void LogTemperatureTable<CoeffType>::locate( const CoeffType lnT, unsigned int& node, CoeffType& t ) const
+  {
+    const CoeffType x = (lnT - _lnT_min)/_dlnT;
+
+    // x is in [0,n_points-1] for T in range, the rounding
+    // being taken care of by clamping
+    node = (x > 0) ? static_cast<unsigned int>(x) : 0;
+    if( node > _n_points - 2 )
+      node = _n_points - 2;
+
+    t = x - node;
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  void LogTemperatureTable<CoeffType>::interpolate( const CoeffType lnT, std::vector<StateType>& values ) const
+  {
+    unsigned int node;
+    CoeffType t;
+    this->locate(lnT,node,t);
+
+    // Hermite basis
+    const CoeffType t2  = t*t;
+    const CoeffType omt = 1 - t;
+    const CoeffType h00 = (1 + 2*t) * omt * omt;
+    const CoeffType h10 = t * omt * omt * _dlnT;
+    const CoeffType h01 = t2 * (3 - 2*t);
+    const CoeffType h11 = t2 * (t - 1) * _dlnT;
+
+    const unsigned int n_functions = this->n_functions();
+    const CoeffType* f0 = &_values[node * n_functions];
+    const CoeffType* f1 = f0 + n_functions;
+    const CoeffType* m0 = &_slopes[node * n_functions];
+    const CoeffType* m1 = m0 + n_functions;
+
+    for( unsigned int f = 0; f < n_functions; f++ )
+      {
+        values[_positions[f]] = h00 * f0[f] + h10 * m0[f] + h01 * f1[f] + h11 * m1[f];
+      }
+  }
+
+  template<typename CoeffType>
+  template <typename StateType>
+  inline
+  void LogTemperatureTable<CoeffType>::interpolate_and_derivs( const CoeffType lnT,
+                                                               std::vector<StateType>& values,
+                                                               std::vector<StateType>& slopes ) const
+  {
+    unsigned int node;
+    CoeffType t;
+    this->locate(lnT,node,t);
+
+    // Hermite basis and derivatives with respect to ln(T)
+    const CoeffType t2  = t*t;
+    const CoeffType omt = 1 - t;
+    const CoeffType h00 = (1 + 2*t) * omt * omt;
+    const CoeffType h10 = t * omt * omt * _dlnT;
+    const CoeffType h01 = t2 * (3 - 2*t);
+    const CoeffType h11 = t2 * (t - 1) * _dlnT;
+
+    const CoeffType dh00 = 6 * (t2 - t) / _dlnT;
+    const CoeffType dh10 = 3*t2 - 4*t + 1;
+    const CoeffType dh01 = - dh00;
+    const CoeffType dh11 = 3*t2 - 2*t;
+
+    const unsigned int n_functions = this->n_functions();
+    const CoeffType* f0 = &_values[node * n_functions];
+    const CoeffType* f1 = f0 + n_functions;
+    const CoeffType* m0 = &_slopes[node * n_functions];
+    const CoeffType* m1 = m0 + n_functions;
+
+    for( unsigned int f = 0; f < n_functions; f++ )
+      {
+        values[_positions[f]] = h00  * f0[f] + h10  * m0[f] + h01  * f1[f] + h11  * m1[f];
+        slopes[_positions[f]] = dh00 * f0[f] + dh10 * m0[f] + dh01 * f1[f] + dh11 * m1[f];
+      }
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_LOG_TEMPERATURE_TABLE_H
@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+
+#ifndef ANTIOCH_PARTIAL_ORDER_H
+#define ANTIOCH_PARTIAL_ORDER_H
+
+// Antioch
+#include "antioch/cmath_shims.h"
+#include "antioch/metaprogramming.h"
+
+namespace Antioch
+{
+  namespace PartialOrder
+  {
+    //! Kind of exponent of a species concentration in a rate of progress
+    /*!
+     * Integer orders up to three are evaluated by multiplications,
+     * anything else by \p pow.
+     */
+    enum PartialOrder { FIRST = 0,
+                        SECOND,
+                        THIRD,
+                        GENERAL };
+
+  } // end namespace PartialOrder
+
+  //! Classifies the partial order \p order
+  template <typename CoeffType>
+  inline
+  PartialOrder::PartialOrder classify_partial_order( const CoeffType order )
+  {
+    if( order == 1 )
+      return PartialOrder::FIRST;
+    if( order == 2 )
+      return PartialOrder::SECOND;
+    if( order == 3 )
+      return PartialOrder::THIRD;
+
+    return PartialOrder::GENERAL;
+  }
+
+  //! \f$X^{order}\f$, \p type being the classification of \p order
+  template <typename StateType, typename CoeffType>
+  inline
+  StateType concentration_power( const StateType& X,
+                                 const PartialOrder::PartialOrder type,
+                                 const CoeffType order )
+  {
+    switch(type)
+      {
+      case PartialOrder::FIRST:
+        return X;
+      case PartialOrder::SECOND:
+        return X * X;
+      case PartialOrder::THIRD:
+        return X * X * X;
+      default:
+        return ant_pow(X,order);
+      }
+  }
+
+  //! \f$X^{order-1}\f$, \p type being the classification of \p order
+  template <typename StateType, typename CoeffType>
+  inline
+  StateType concentration_power_minus_one( const StateType& X,
+                                           const PartialOrder::PartialOrder type,
+                                           const CoeffType order )
+  {
+    switch(type)
+      {
+      case PartialOrder::FIRST:
+        return Antioch::constant_clone(X,1);
+      case PartialOrder::SECOND:
+        return X;
+      case PartialOrder::THIRD:
+        return X * X;
+      default:
+        return ant_pow(X,order - 1);
+      }
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_PARTIAL_ORDER_H
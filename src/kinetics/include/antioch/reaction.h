@@ -41,11 +41,13 @@
 #include "antioch/vanthoff_rate.h"
 #include "antioch/photochemical_rate.h"
 #include "antioch/reaction_enum.h"
+#include "antioch/partial_order.h"
 #include "antioch/chemical_mixture.h"
 #include "antioch/kinetics_conditions.h"
 #include "antioch/kinetics_parsing.h" // reset_parameter_of_rate
 
 //C++
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <limits>
@@ -147,6 +149,9 @@ namespace Antioch
      */
     void set_maximum_rate( const CoeffType max_rate);
 
+    //! Maximum reaction rate.
+    CoeffType maximum_rate() const;
+
     //! Model of kinetics.
     KineticsModel::KineticsModel kinetics_model() const;
 
@@ -208,6 +213,12 @@ namespace Antioch
     //!
     CoeffType product_partial_order(const unsigned int p) const;
 
+    //! Classification of reactant_partial_order(r), set by initialize()
+    PartialOrder::PartialOrder reactant_partial_order_type(const unsigned int r) const;
+
+    //! Classification of product_partial_order(p), set by initialize()
+    PartialOrder::PartialOrder product_partial_order_type(const unsigned int p) const;
+
     //!
     void add_reactant( const std::string &name,
                        const unsigned int r_id,
@@ -237,6 +248,26 @@ namespace Antioch
     //!
     CoeffType efficiency( const unsigned int s) const;
 
+    //! True for the three-body reactions, the only ones with efficiencies
+    bool has_efficiencies() const;
+
+    //! Number of species whose efficiency is not the default of 1
+    unsigned int n_efficiency_overrides() const;
+
+    //! Species of the \p i-th efficiency override, by increasing species index
+    unsigned int efficiency_override_id( const unsigned int i ) const;
+
+    //! Efficiency of the \p i-th efficiency override
+    CoeffType efficiency_override( const unsigned int i ) const;
+
+    //! \f$[\mathrm{M}] = \sum_s\epsilon_sc_s\f$ from the total concentration \p total
+    /*! Only the efficiency overrides are visited,
+     *  \f$[\mathrm{M}] = \sum_sc_s + \sum_{\epsilon_s \neq 1}(\epsilon_s - 1)c_s\f$
+     */
+    template <typename StateType, typename VectorStateType>
+    StateType efficiency_weighted_concentration( const StateType& total,
+                                                 const VectorStateType& molar_densities ) const;
+
     //! Computes derived quantities.
     void initialize(unsigned int index = 0);
 
@@ -286,6 +317,17 @@ namespace Antioch
                                                            StateType& dkfwd_dT,
                                                            VectorStateType& dkfwd_dX) const;
 
+    //! \f$\frac{\partial \ln k_f}{\partial \ln k_i}\f$ for each rate constant \f$k_i\f$
+    /*! One for a single rate constant, \f$k_i/k_f\f$ for duplicate
+     *  reactions, and for falloff reactions the low and high pressure
+     *  parts, which sum to one. The first n_rate_constants() entries of
+     *  \p dlnkfwd_dlnk are filled.
+     */
+    template <typename StateType, typename VectorStateType, typename VectorRatesType>
+    void compute_forward_rate_coefficient_log_sensitivities( const VectorStateType& molar_densities,
+                                                             const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                             VectorRatesType& dlnkfwd_dlnk) const;
+
     ////
     template <typename StateType, typename VectorStateType>
     StateType compute_rate_of_progress( const VectorStateType& molar_densities,
@@ -293,6 +335,16 @@ namespace Antioch
                                         const StateType& P0_RT,
                                         const VectorStateType& h_RT_minus_s_R) const;
 
+    //! Same as above, with the equilibrium constant \p keq already computed
+    /*! E.g. by ReactionSet::compute_equilibrium_constants().
+     *  \p keq is not used by irreversible reactions, nor by the ones
+     *  with an explicit reverse rate.
+     */
+    template <typename StateType, typename VectorStateType>
+    StateType compute_rate_of_progress( const VectorStateType& molar_densities,
+                                        const KineticsConditions<StateType,VectorStateType>& conditions,
+                                        const StateType& keq) const;
+
     // Deprecated API for backwards compatibility
     template <typename StateType, typename VectorStateType>
     StateType compute_rate_of_progress( const VectorStateType& molar_densities,
@@ -311,6 +363,36 @@ namespace Antioch
                                                    StateType& dnet_rate_dT,
                                                    VectorStateType& dnet_rate_dX_s ) const;
 
+    //! Same as above, with a caller-owned n_species-sized scratch vector
+    /*! \p dkfwd_dX_s is overwritten with the concentration derivatives of the
+     *  forward rate coefficient. Nothing is allocated for scalar StateTypes.
+     */
+    template <typename StateType, typename VectorStateType>
+    void compute_rate_of_progress_and_derivatives( const VectorStateType &molar_densities,
+                                                   const ChemicalMixture<CoeffType>& /*chem_mixture*/,
+                                                   const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                   const StateType &P0_RT,
+                                                   const VectorStateType &h_RT_minus_s_R,
+                                                   const VectorStateType &dh_RT_minus_s_R_dT,
+                                                   StateType& net_reaction_rate,
+                                                   StateType& dnet_rate_dT,
+                                                   VectorStateType& dnet_rate_dX_s,
+                                                   VectorStateType& dkfwd_dX_s ) const;
+
+    //! Same as above, with the equilibrium constant \p keq and its temperature
+    //  derivative \p dkeq_dT already computed, not used by irreversible reactions
+    //  nor by the ones with an explicit reverse rate.
+    template <typename StateType, typename VectorStateType>
+    void compute_rate_of_progress_and_derivatives( const VectorStateType &molar_densities,
+                                                   const ChemicalMixture<CoeffType>& /*chem_mixture*/,
+                                                   const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                   const StateType &keq,
+                                                   const StateType &dkeq_dT,
+                                                   StateType& net_reaction_rate,
+                                                   StateType& dnet_rate_dT,
+                                                   VectorStateType& dnet_rate_dX_s,
+                                                   VectorStateType& dkfwd_dX_s ) const;
+
     // Deprecated API for backwards compatibility
     template <typename StateType, typename VectorStateType>
     void compute_rate_of_progress_and_derivatives( const VectorStateType &molar_densities,
@@ -345,6 +427,26 @@ namespace Antioch
     //! Return the number of rate constant objects
     unsigned int n_rate_constants() const;
 
+    //! Set an explicit reverse rate constant, the ownership is transfered
+    /*!
+     * The reverse rate coefficient of the reaction is then given by \p rate,
+     * times \f$[\mathrm{M}]\f$ for a three-body reaction, instead of
+     * \f$k_f/K_{eq}\f$: the equilibrium constant is not evaluated any more.
+     * Only the elementary, duplicate and three-body reactions accept one.
+     */
+    void set_reverse_rate(KineticsType<CoeffType,VectorCoeffType> *rate);
+
+    //! True if the reverse rate constant is given explicitly
+    bool has_reverse_rate() const;
+
+    //! Return const reference to the explicit reverse rate object
+    const KineticsType<CoeffType,VectorCoeffType>& reverse_rate() const;
+
+    //! Reverse rate coefficient from the explicit reverse rate constant
+    template <typename StateType, typename VectorStateType>
+    StateType compute_reverse_rate_coefficient( const VectorStateType& molar_densities,
+                                                const KineticsConditions<StateType,VectorStateType>& conditions) const;
+
     //! Formatted print, by default to \p std::cout.
     void print(std::ostream& os = std::cout) const;
 
@@ -370,6 +472,8 @@ namespace Antioch
     std::vector<unsigned int> _species_product_stoichiometry;
     std::vector<CoeffType>    _species_reactant_partial_order;
     std::vector<CoeffType>    _species_product_partial_order;
+    std::vector<PartialOrder::PartialOrder> _species_reactant_partial_order_type;
+    std::vector<PartialOrder::PartialOrder> _species_product_partial_order_type;
     std::vector<int>          _species_delta_stoichiometry;
     int _gamma;
     bool _initialized;
@@ -381,8 +485,13 @@ namespace Antioch
     //! The forward reaction rate modified Arrhenius form.
     std::vector<KineticsType<CoeffType,VectorCoeffType>* > _forward_rate;
 
-    //! efficiencies for three body reactions
-    std::vector<CoeffType> _efficiencies;
+    //! The explicit reverse rate, NULL if given by the equilibrium constant
+    KineticsType<CoeffType,VectorCoeffType>* _reverse_rate;
+
+    //! efficiencies for three body reactions, stored as overrides
+    //  of the default efficiency of 1, sorted by species index
+    std::vector<unsigned int> _efficiency_ids;
+    std::vector<CoeffType>    _efficiency_values;
 
   private:
     Reaction();
@@ -448,6 +557,13 @@ namespace Antioch
     _max_rate = max_rate;
   }
 
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  CoeffType Reaction<CoeffType,VectorCoeffType>::maximum_rate() const
+  {
+    return _max_rate;
+  }
+
   template<typename CoeffType,typename VectorCoeffType>
   inline
   KineticsModel::KineticsModel Reaction<CoeffType,VectorCoeffType>::kinetics_model() const
@@ -492,6 +608,36 @@ namespace Antioch
     return _forward_rate.size();
   }
 
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  void Reaction<CoeffType,VectorCoeffType>::set_reverse_rate(KineticsType<CoeffType,VectorCoeffType> *rate)
+  {
+    if(_type != ReactionType::ELEMENTARY &&
+       _type != ReactionType::DUPLICATE  &&
+       _type != ReactionType::THREE_BODY)
+      antioch_error_msg("Only elementary, duplicate and three-body reactions accept a reverse rate, not reaction " + _equation);
+
+    delete _reverse_rate;
+    _reverse_rate = rate;
+
+    return;
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  bool Reaction<CoeffType,VectorCoeffType>::has_reverse_rate() const
+  {
+    return _reverse_rate != NULL;
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  const KineticsType<CoeffType,VectorCoeffType>& Reaction<CoeffType,VectorCoeffType>::reverse_rate() const
+  {
+    antioch_assert(_reverse_rate);
+    return *_reverse_rate;
+  }
+
   template<typename CoeffType, typename VectorCoeffType>
   inline
   void Reaction<CoeffType,VectorCoeffType>::swap_forward_rates(unsigned int irate, unsigned int jrate)
@@ -596,6 +742,22 @@ namespace Antioch
     return _species_product_partial_order[p];
   }
 
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  PartialOrder::PartialOrder Reaction<CoeffType,VectorCoeffType>::reactant_partial_order_type(const unsigned int r) const
+  {
+    antioch_assert_less(r, _species_reactant_partial_order_type.size());
+    return _species_reactant_partial_order_type[r];
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  PartialOrder::PartialOrder Reaction<CoeffType,VectorCoeffType>::product_partial_order_type(const unsigned int p) const
+  {
+    antioch_assert_less(p, _species_product_partial_order_type.size());
+    return _species_product_partial_order_type[p];
+  }
+
   template<typename CoeffType, typename VectorCoeffType>
   inline
   void Reaction<CoeffType,VectorCoeffType>::add_reactant (const std::string &name,
@@ -654,25 +816,100 @@ namespace Antioch
                                             const unsigned int s,
                                             const CoeffType efficiency)
   {
-    antioch_assert_less(s, _efficiencies.size());
-    _efficiencies[s] = efficiency;
+    antioch_assert(this->has_efficiencies());
+    antioch_assert_less(s, this->n_species());
+
+    const typename std::vector<unsigned int>::iterator it =
+      std::lower_bound(_efficiency_ids.begin(), _efficiency_ids.end(), s);
+    const unsigned int i = it - _efficiency_ids.begin();
+
+    if(it != _efficiency_ids.end() && *it == s)
+      {
+        if(efficiency == 1)
+          {
+            _efficiency_ids.erase(it);
+            _efficiency_values.erase(_efficiency_values.begin() + i);
+          }
+        else
+          {
+            _efficiency_values[i] = efficiency;
+          }
+      }
+    else if(efficiency != 1)
+      {
+        _efficiency_ids.insert(it, s);
+        _efficiency_values.insert(_efficiency_values.begin() + i, efficiency);
+      }
   }
 
   template<typename CoeffType, typename VectorCoeffType>
   inline
   CoeffType Reaction<CoeffType,VectorCoeffType>::get_efficiency (const unsigned int s) const
   {
-    antioch_assert_less(s, _efficiencies.size());
-    return _efficiencies[s];
+    return this->efficiency(s);
   }
 
   template<typename CoeffType, typename VectorCoeffType>
   inline
   CoeffType Reaction<CoeffType,VectorCoeffType>::efficiency( const unsigned int s ) const
   {
+    antioch_assert(this->has_efficiencies());
+    antioch_assert_less(s, this->n_species());
+
+    const typename std::vector<unsigned int>::const_iterator it =
+      std::lower_bound(_efficiency_ids.begin(), _efficiency_ids.end(), s);
+
+    if(it != _efficiency_ids.end() && *it == s)
+      return _efficiency_values[it - _efficiency_ids.begin()];
+
+    return 1;
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  bool Reaction<CoeffType,VectorCoeffType>::has_efficiencies() const
+  {
+    return (_type == ReactionType::THREE_BODY ||
+            _type == ReactionType::LINDEMANN_FALLOFF_THREE_BODY ||
+            _type == ReactionType::TROE_FALLOFF_THREE_BODY);
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  unsigned int Reaction<CoeffType,VectorCoeffType>::n_efficiency_overrides() const
+  {
+    return _efficiency_ids.size();
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  unsigned int Reaction<CoeffType,VectorCoeffType>::efficiency_override_id( const unsigned int i ) const
+  {
+    antioch_assert_less(i, _efficiency_ids.size());
+    return _efficiency_ids[i];
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  inline
+  CoeffType Reaction<CoeffType,VectorCoeffType>::efficiency_override( const unsigned int i ) const
+  {
+    antioch_assert_less(i, _efficiency_values.size());
+    return _efficiency_values[i];
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  StateType Reaction<CoeffType,VectorCoeffType>::efficiency_weighted_concentration( const StateType& total,
+                                                                                   const VectorStateType& molar_densities ) const
+  {
+    StateType M = total;
+    for(unsigned int i = 0; i < _efficiency_ids.size(); i++)
+      {
+        M += (_efficiency_values[i] - 1) * molar_densities[_efficiency_ids[i]];
+      }
 
-    antioch_assert(s < _efficiencies.size());
-    return _efficiencies[s];
+    return M;
   }
 
   template<typename CoeffType, typename VectorCoeffType>
@@ -713,7 +950,8 @@ namespace Antioch
       _reversible(reversible),
       _max_rate(std::numeric_limits<CoeffType>::infinity()),
       _type(type),
-      _kintype(kin)
+      _kintype(kin),
+      _reverse_rate(NULL)
   {
      return;
   }
@@ -728,6 +966,8 @@ namespace Antioch
         delete _forward_rate[ir];
       }
 
+    delete _reverse_rate;
+
     return;
   }
 
@@ -747,12 +987,27 @@ namespace Antioch
         _gamma += this->product_stoichiometric_coefficient(p);
       }
 
+    // integer orders are evaluated without pow
+    _species_reactant_partial_order_type.resize(this->n_reactants());
+    for (unsigned int r=0; r< this->n_reactants(); r++)
+      {
+        _species_reactant_partial_order_type[r] = classify_partial_order(this->reactant_partial_order(r));
+      }
+
+    _species_product_partial_order_type.resize(this->n_products());
+    for (unsigned int p=0; p < this->n_products(); p++)
+      {
+        _species_product_partial_order_type[p] = classify_partial_order(this->product_partial_order(p));
+      }
+
      // gives kinetics object index in reaction set
      for(typename std::vector<KineticsType<CoeffType,VectorCoeffType>* >::iterator it = _forward_rate.begin();
                 it != _forward_rate.end(); it++)
      {
         (*it)->set_index(index);
      }
+     if(_reverse_rate)
+       _reverse_rate->set_index(index);
 
     // set initialization flag
     _initialized = true;
@@ -863,10 +1118,10 @@ namespace Antioch
       {
         os << "\n#   forward rate eqn: " << *_forward_rate[ir];
       }
+    if(_reverse_rate)
+      os << "\n#   reverse rate eqn: " << *_reverse_rate;
 
-    if (_type == ReactionType::THREE_BODY ||
-        _type == ReactionType::LINDEMANN_FALLOFF_THREE_BODY ||
-        _type == ReactionType::TROE_FALLOFF_THREE_BODY)
+    if (this->has_efficiencies())
       {
         os << "\n#   efficiencies: ";
         for (unsigned int s=0; s<this->n_species(); s++)
@@ -937,6 +1192,74 @@ namespace Antioch
     return zero_clone(conditions.T());
   }
 
+  template<typename CoeffType, typename VectorCoeffType>
+  template <typename StateType, typename VectorStateType, typename VectorRatesType>
+  inline
+  void Reaction<CoeffType,VectorCoeffType>::compute_forward_rate_coefficient_log_sensitivities( const VectorStateType& molar_densities,
+                                                                                               const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                                               VectorRatesType& dlnkfwd_dlnk) const
+  {
+    antioch_assert_greater_equal(dlnkfwd_dlnk.size(), this->n_rate_constants());
+
+    switch(_type)
+      {
+      case(ReactionType::ELEMENTARY):
+      case(ReactionType::THREE_BODY):
+        {
+          dlnkfwd_dlnk[0] = constant_clone(conditions.T(),1);
+        }
+        break;
+
+      case(ReactionType::DUPLICATE):
+        {
+          StateType kfwd = zero_clone(conditions.T());
+          for(unsigned int ir = 0; ir < this->n_rate_constants(); ir++)
+            {
+              dlnkfwd_dlnk[ir] = (*_forward_rate[ir])(conditions);
+              kfwd += dlnkfwd_dlnk[ir];
+            }
+          for(unsigned int ir = 0; ir < this->n_rate_constants(); ir++)
+            dlnkfwd_dlnk[ir] /= kfwd;
+        }
+        break;
+
+      case(ReactionType::LINDEMANN_FALLOFF):
+        {
+          dlnkfwd_dlnk[0] = (static_cast<const FalloffReaction<CoeffType,LindemannFalloff<CoeffType> >*>(this))->compute_low_pressure_log_sensitivity(molar_densities,conditions);
+          dlnkfwd_dlnk[1] = constant_clone(conditions.T(),1) - dlnkfwd_dlnk[0];
+        }
+        break;
+
+      case(ReactionType::TROE_FALLOFF):
+        {
+          dlnkfwd_dlnk[0] = (static_cast<const FalloffReaction<CoeffType,TroeFalloff<CoeffType> >*>(this))->compute_low_pressure_log_sensitivity(molar_densities,conditions);
+          dlnkfwd_dlnk[1] = constant_clone(conditions.T(),1) - dlnkfwd_dlnk[0];
+        }
+        break;
+
+      case(ReactionType::LINDEMANN_FALLOFF_THREE_BODY):
+        {
+          dlnkfwd_dlnk[0] = (static_cast<const FalloffThreeBodyReaction<CoeffType,LindemannFalloff<CoeffType> >*>(this))->compute_low_pressure_log_sensitivity(molar_densities,conditions);
+          dlnkfwd_dlnk[1] = constant_clone(conditions.T(),1) - dlnkfwd_dlnk[0];
+        }
+        break;
+
+      case(ReactionType::TROE_FALLOFF_THREE_BODY):
+        {
+          dlnkfwd_dlnk[0] = (static_cast<const FalloffThreeBodyReaction<CoeffType,TroeFalloff<CoeffType> >*>(this))->compute_low_pressure_log_sensitivity(molar_densities,conditions);
+          dlnkfwd_dlnk[1] = constant_clone(conditions.T(),1) - dlnkfwd_dlnk[0];
+        }
+        break;
+
+      default:
+        {
+          antioch_error();
+        }
+      } // switch(_type)
+
+    return;
+  }
+
   template<typename CoeffType, typename VectorCoeffType>
   template <typename StateType, typename VectorStateType>
   inline
@@ -989,6 +1312,7 @@ namespace Antioch
         {
           (static_cast<const FalloffReaction<CoeffType,TroeFalloff<CoeffType> >*>(this))->compute_forward_rate_coefficient_and_derivatives(molar_densities,conditions,kfwd,dkfwd_dT,dkfwd_dX);
         }
+        break;
 
       case(ReactionType::LINDEMANN_FALLOFF_THREE_BODY):
         {
@@ -1030,6 +1354,33 @@ namespace Antioch
        kfwd, dkfwd_dT, dkfwd_dX);
   }
 
+  template<typename CoeffType, typename VectorCoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  StateType Reaction<CoeffType,VectorCoeffType>::compute_reverse_rate_coefficient( const VectorStateType& molar_densities,
+                                                                                   const KineticsConditions<StateType,VectorStateType>& conditions) const
+  {
+    antioch_assert(_reverse_rate);
+
+    StateType kbkwd = (*_reverse_rate)(conditions);
+
+    // k(T,[M]) = [M] * k(T) for three-body reactions
+    if(_type == ReactionType::THREE_BODY)
+      {
+        StateType M = molar_densities[0];
+        for (unsigned int s=1; s<this->n_species(); s++)
+          {
+            M += molar_densities[s];
+          }
+
+        kbkwd *= this->efficiency_weighted_concentration(M,molar_densities);
+      }
+
+    antioch_assert(!has_nan(kbkwd));
+
+    return kbkwd;
+  }
+
   //kfwd *prod_r [R]^nu_r - kbkwd * prod_p [P]^nu_p ( = - 1/nu_r d[R]/dt)
   template<typename CoeffType, typename VectorCoeffType>
   template <typename StateType, typename VectorStateType>
@@ -1038,6 +1389,21 @@ namespace Antioch
                                                            const KineticsConditions<StateType,VectorStateType>& conditions,
                                                            const StateType& P0_RT,
                                                            const VectorStateType& h_RT_minus_s_R) const
+  {
+    if(_reversible && !_reverse_rate)
+      return this->compute_rate_of_progress( molar_densities, conditions,
+                                             this->equilibrium_constant( P0_RT, h_RT_minus_s_R ) );
+
+    // the equilibrium constant is not needed
+    return this->compute_rate_of_progress( molar_densities, conditions, Antioch::constant_clone(P0_RT,1) );
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  StateType Reaction<CoeffType,VectorCoeffType>::compute_rate_of_progress( const VectorStateType& molar_densities,
+                                                           const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                           const StateType& Keq) const
   {
     using std::abs;
 
@@ -1052,14 +1418,30 @@ namespace Antioch
     for (unsigned int ro=0; ro < this->n_reactants(); ro++)
       {
         kfwd_times_reactants     *=
-          ant_pow( molar_densities[this->reactant_id(ro)],
-            this->reactant_partial_order(ro));
+          concentration_power( molar_densities[this->reactant_id(ro)],
+                               this->reactant_partial_order_type(ro),
+                               this->reactant_partial_order(ro));
       }
     antioch_assert(!has_nan(kfwd_times_reactants));
 
+    if(_reversible && _reverse_rate)
+    {
+      StateType kbkwd_times_products = this->compute_reverse_rate_coefficient(molar_densities,conditions);
+
+      // Rbkwd
+      for (unsigned int po=0; po< this->n_products(); po++)
+        {
+          kbkwd_times_products     *=
+            concentration_power( molar_densities[this->product_id(po)],
+                                 this->product_partial_order_type(po),
+                                 this->product_partial_order(po));
+        }
+
+      return kfwd_times_reactants - kbkwd_times_products;
+    }
+
     if(_reversible)
     {
-      StateType Keq = this->equilibrium_constant( P0_RT, h_RT_minus_s_R );
       antioch_assert(!has_nan(Keq));
 
       StateType kbkwd_times_products = kfwd/Keq;
@@ -1068,8 +1450,9 @@ namespace Antioch
       for (unsigned int po=0; po< this->n_products(); po++)
         {
           kbkwd_times_products     *=
-            ant_pow( molar_densities[this->product_id(po)],
-              this->product_partial_order(po));
+            concentration_power( molar_densities[this->product_id(po)],
+                                 this->product_partial_order_type(po),
+                                 this->product_partial_order(po));
         }
 
       // If we have an equilibrium constant of zero, our reverse
@@ -1106,7 +1489,7 @@ namespace Antioch
   template <typename StateType, typename VectorStateType>
   inline
   void Reaction<CoeffType,VectorCoeffType>::compute_rate_of_progress_and_derivatives( const VectorStateType &molar_densities,
-                                                                      const ChemicalMixture<CoeffType>& /*chem_mixture*/,
+                                                                      const ChemicalMixture<CoeffType>& chem_mixture,
                                                                       const KineticsConditions<StateType,VectorStateType>& conditions,
                                                                       const StateType &P0_RT,
                                                                       const VectorStateType &h_RT_minus_s_R,
@@ -1114,180 +1497,243 @@ namespace Antioch
                                                                       StateType& net_reaction_rate,
                                                                       StateType& dnet_rate_dT,
                                                                       VectorStateType& dnet_rate_dX_s ) const
+  {
+    VectorStateType dkfwd_dX_s = Antioch::zero_clone(molar_densities);
+
+    this->compute_rate_of_progress_and_derivatives( molar_densities, chem_mixture, conditions, P0_RT,
+                                                    h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                                    net_reaction_rate, dnet_rate_dT, dnet_rate_dX_s,
+                                                    dkfwd_dX_s );
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void Reaction<CoeffType,VectorCoeffType>::compute_rate_of_progress_and_derivatives( const VectorStateType &molar_densities,
+                                                                      const ChemicalMixture<CoeffType>& chem_mixture,
+                                                                      const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                      const StateType &P0_RT,
+                                                                      const VectorStateType &h_RT_minus_s_R,
+                                                                      const VectorStateType &dh_RT_minus_s_R_dT,
+                                                                      StateType& net_reaction_rate,
+                                                                      StateType& dnet_rate_dT,
+                                                                      VectorStateType& dnet_rate_dX_s,
+                                                                      VectorStateType& dkfwd_dX_s ) const
+  {
+    StateType keq = Antioch::constant_clone(conditions.T(),1);
+    StateType dkeq_dT = Antioch::zero_clone(conditions.T());
+
+    if(_reversible && !_reverse_rate)
+      equilibrium_constant_and_derivative( conditions.T(), P0_RT, h_RT_minus_s_R,
+                                           dh_RT_minus_s_R_dT,
+                                           keq, dkeq_dT );
+
+    this->compute_rate_of_progress_and_derivatives( molar_densities, chem_mixture, conditions, keq, dkeq_dT,
+                                                    net_reaction_rate, dnet_rate_dT, dnet_rate_dX_s,
+                                                    dkfwd_dX_s );
+  }
+
+  template<typename CoeffType, typename VectorCoeffType>
+  template <typename StateType, typename VectorStateType>
+  inline
+  void Reaction<CoeffType,VectorCoeffType>::compute_rate_of_progress_and_derivatives( const VectorStateType &molar_densities,
+                                                                      const ChemicalMixture<CoeffType>& /*chem_mixture*/,
+                                                                      const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                      const StateType &keq,
+                                                                      const StateType &dkeq_dT,
+                                                                      StateType& net_reaction_rate,
+                                                                      StateType& dnet_rate_dT,
+                                                                      VectorStateType& dnet_rate_dX_s,
+                                                                      VectorStateType& dkfwd_dX_s ) const
   {
     antioch_assert_equal_to (molar_densities.size(), this->n_species());
+    antioch_assert_equal_to (dnet_rate_dX_s.size(), this->n_species());
+    antioch_assert_equal_to (dkfwd_dX_s.size(), this->n_species());
 
 // First the forward component, if reversible, compute and add the backward component
 
     StateType kfwd = Antioch::zero_clone(conditions.T());
     StateType dkfwd_dT = Antioch::zero_clone(conditions.T());
-    VectorStateType dkfwd_dX_s = Antioch::zero_clone(molar_densities);
-    VectorStateType dkbkwd_dX_s = Antioch::zero_clone(molar_densities);
 
     this->compute_forward_rate_coefficient_and_derivatives(molar_densities, conditions, kfwd, dkfwd_dT ,dkfwd_dX_s);
 
-    // If users want to use valarrays, then the output reference sizes
-    // had better already match the input value sizes...
-    StateType dRfwd_dT = Antioch::zero_clone(kfwd);
-
-    // We need to construct using an input StateType argument if we
-    // want StateType==valarray to have the right sizes
-    // valarray compatibility makes this a bit redundant, but not much
-    // worse than the previous version
-    /*! \todo Should we make this work arrays that get passed in so we aren't allocating/deallocating here? */
-    VectorStateType dRfwd_dX_s(this->n_species(), kfwd);
-
-    Antioch::set_zero(dRfwd_dX_s);
-
-    // pre-fill the participating species partials with the rates
-    for (unsigned int r=0; r< this->n_reactants(); r++)
+    // Rfwd & derivatives
+    //
+    // dRfwd_dX_s = prod_r X_r^o_r * dkfwd_dX_s
+    //            + kfwd * d(prod_r X_r^o_r)/dX_s
+    StateType facfwd = constant_clone(conditions.T(),1);
+    for (unsigned int ro=0; ro < this->n_reactants(); ro++)
       {
-        dRfwd_dX_s[this->reactant_id(r)] = kfwd;
+        facfwd *= concentration_power( molar_densities[this->reactant_id(ro)],
+                                       this->reactant_partial_order_type(ro),
+                                       this->reactant_partial_order(ro));
       }
 
-    //init
-    StateType facfwd = constant_clone(conditions.T(),1);
-    dRfwd_dT = dkfwd_dT;
+    for (unsigned int s = 0; s < this->n_species(); s++)
+      {
+        dnet_rate_dX_s[s] = facfwd * dkfwd_dX_s[s];
+      }
 
-    // Rfwd & derivatives
     for (unsigned int ro=0; ro < this->n_reactants(); ro++)
       {
-        const StateType val =
-          ant_pow( molar_densities[this->reactant_id(ro)],
-            this->reactant_partial_order(ro));
-
-        const StateType dval =
-          ( static_cast<CoeffType>(this->reactant_stoichiometric_coefficient(ro))*
-            ant_pow( molar_densities[this->reactant_id(ro)],
-              this->reactant_partial_order(ro) - 1)
-            );
-
-        facfwd   *= val;
-        dRfwd_dT *= val;
+        StateType dRfwd_dX =
+          kfwd * ( static_cast<CoeffType>(this->reactant_stoichiometric_coefficient(ro))*
+                   concentration_power_minus_one( molar_densities[this->reactant_id(ro)],
+                                                  this->reactant_partial_order_type(ro),
+                                                  this->reactant_partial_order(ro))
+                 );
 
         for (unsigned int ri=0; ri<this->n_reactants(); ri++)
           {
-            dRfwd_dX_s[this->reactant_id(ri)] *= (ri == ro) ? dval : val;
+            if (ri != ro)
+              dRfwd_dX *= concentration_power( molar_densities[this->reactant_id(ri)],
+                                               this->reactant_partial_order_type(ri),
+                                               this->reactant_partial_order(ri));
           }
-      }
 
-    for (unsigned int s = 0; s < this->n_species(); s++)
-      {
-        dRfwd_dX_s[s] += facfwd * dkfwd_dX_s[s];
+        dnet_rate_dX_s[this->reactant_id(ro)] += dRfwd_dX;
       }
 
     net_reaction_rate = facfwd * kfwd;
 
-    dnet_rate_dT = dRfwd_dT;
-
-    for (unsigned int s = 0; s < this->n_species(); s++)
-      {
-        dnet_rate_dX_s[s] = dRfwd_dX_s[s];
-      }
+    dnet_rate_dT = facfwd * dkfwd_dT;
 
-    if(_reversible)
+    if(_reversible && _reverse_rate)
     {
 
-    //backward to be computed and added
+    //backward from the explicit reverse rate
 
-      StateType keq = Antioch::zero_clone(conditions.T());
-      StateType dkeq_dT = Antioch::zero_clone(conditions.T());
-
-      equilibrium_constant_and_derivative( conditions.T(), P0_RT, h_RT_minus_s_R,
-                                           dh_RT_minus_s_R_dT,
-                                           keq, dkeq_dT );
+      StateType kbkwd = Antioch::zero_clone(conditions.T());
+      StateType dkbkwd_dT = Antioch::zero_clone(conditions.T());
+      _reverse_rate->compute_rate_and_derivative(conditions,kbkwd,dkbkwd_dT);
 
-      const StateType kbkwd = kfwd/keq;
-      const StateType dkbkwd_dT = (dkfwd_dT - kbkwd*dkeq_dT)/keq;
-      for(unsigned int s = 0; s < this->n_species(); s++)
+      StateType facbkwd = constant_clone(conditions.T(),1);
+      for (unsigned int po=0; po< this->n_products(); po++)
         {
-          dkbkwd_dX_s[s] = dkfwd_dX_s[s]/keq;
+          facbkwd *= concentration_power( molar_densities[this->product_id(po)],
+                                          this->product_partial_order_type(po),
+                                          this->product_partial_order(po));
         }
 
-      // If users want to use valarrays, then the output reference sizes
-      // had better already match the input value sizes...
-      StateType dRbkwd_dT = Antioch::zero_clone(dkbkwd_dT);
+      // three-body, dkbkwd_dX_s = k(T) * eps_s
+      if(_type == ReactionType::THREE_BODY)
+        {
+          const StateType dRbkwd_dM = facbkwd * kbkwd;
 
-      // We need to construct using an input StateType argument if we
-      // want StateType==valarray to have the right sizes
-      // valarray compatibility makes this a bit redundant, but not much
-      // worse than the previous version
-      /*! \todo Should we make this work arrays that get passed in so we aren't allocating/deallocating here? */
-      VectorStateType dRbkwd_dX_s(this->n_species(), kbkwd);
+          StateType M = molar_densities[0];
+          dnet_rate_dX_s[0] -= dRbkwd_dM;
+          for (unsigned int s = 1; s < this->n_species(); s++)
+            {
+              M += molar_densities[s];
+              dnet_rate_dX_s[s] -= dRbkwd_dM;
+            }
 
-      Antioch::set_zero(dRbkwd_dX_s);
+          for (unsigned int i = 0; i < this->n_efficiency_overrides(); i++)
+            {
+              dnet_rate_dX_s[this->efficiency_override_id(i)] -= (this->efficiency_override(i) - 1) * dRbkwd_dM;
+            }
 
-      // pre-fill the participating species partials with the rates
-      for (unsigned int p=0; p < this->n_products(); p++)
-        {
-          dRbkwd_dX_s[this->product_id(p)] = kbkwd;
+          M = this->efficiency_weighted_concentration(M,molar_densities);
+          kbkwd *= M;
+          dkbkwd_dT *= M;
         }
 
-      //init
-      StateType facbkwd = constant_clone(conditions.T(),1);
-      dRbkwd_dT = dkbkwd_dT;
-
-      // Rbkwd & derivatives
       for (unsigned int po=0; po< this->n_products(); po++)
         {
-          const StateType val =
-            ant_pow( molar_densities[this->product_id(po)],
-              this->product_partial_order(po));
-
-          const StateType dval =
-            ( static_cast<CoeffType>(this->product_stoichiometric_coefficient(po))*
-              ant_pow( molar_densities[this->product_id(po)],
-              this->product_partial_order(po) - 1)
-              );
-
-          facbkwd   *= val;
-          dRbkwd_dT *= val;
+          StateType dRbkwd_dX =
+            kbkwd * ( static_cast<CoeffType>(this->product_stoichiometric_coefficient(po))*
+                      concentration_power_minus_one( molar_densities[this->product_id(po)],
+                                                     this->product_partial_order_type(po),
+                                                     this->product_partial_order(po))
+                    );
 
           for (unsigned int pi=0; pi<this->n_products(); pi++)
             {
-              dRbkwd_dX_s[this->product_id(pi)] *= (pi == po) ? dval : val;
+              if (pi != po)
+                dRbkwd_dX *= concentration_power( molar_densities[this->product_id(pi)],
+                                                  this->product_partial_order_type(pi),
+                                                  this->product_partial_order(pi));
             }
 
+          dnet_rate_dX_s[this->product_id(po)] -= dRbkwd_dX;
         }
 
-      for (unsigned int s = 0; s < this->n_species(); s++)
+      net_reaction_rate -= facbkwd * kbkwd;
+
+      dnet_rate_dT -= facbkwd * dkbkwd_dT;
+
+      return;
+    }
+
+    if(_reversible)
+    {
+
+    //backward to be computed and added
+
+      const StateType kbkwd = kfwd/keq;
+      const StateType dkbkwd_dT = (dkfwd_dT - kbkwd*dkeq_dT)/keq;
+
+      StateType facbkwd = constant_clone(conditions.T(),1);
+      for (unsigned int po=0; po< this->n_products(); po++)
         {
-          dRbkwd_dX_s[s] += facbkwd * dkbkwd_dX_s[s];
+          facbkwd *= concentration_power( molar_densities[this->product_id(po)],
+                                          this->product_partial_order_type(po),
+                                          this->product_partial_order(po));
         }
 
-      StateType kbkwd_times_products = facbkwd * kbkwd;
-
       // If we have an equilibrium constant of zero, our reverse
       // reaction rate should be infinity or a user-specified
       // _max_rate, not NaN.
       typename Antioch::rebind<StateType,bool>::type is_nonzero = (keq != Antioch::zero_clone(keq));
+
+      StateType kbkwd_times_products = facbkwd * kbkwd;
       kbkwd_times_products =
 	Antioch::if_else(is_nonzero, kbkwd_times_products,
                          Antioch::constant_clone(keq, this->_max_rate));
       antioch_assert(!has_nan(kbkwd_times_products));
 
       // If our rate is maxed out then our derivatives are zero.
+      StateType dRbkwd_dT = facbkwd * dkbkwd_dT;
       dRbkwd_dT =
 	Antioch::if_else(is_nonzero, dRbkwd_dT,
                          Antioch::zero_clone(keq));
       antioch_assert(!has_nan(dRbkwd_dT));
 
+      // Rbkwd & derivatives, dkbkwd_dX_s = dkfwd_dX_s/keq
       for (unsigned int s = 0; s < this->n_species(); s++)
         {
-          dRbkwd_dX_s[s] =
-	    Antioch::if_else(is_nonzero, dRbkwd_dX_s[s],
+          StateType dRbkwd_dX = facbkwd * dkfwd_dX_s[s]/keq;
+          dnet_rate_dX_s[s] -=
+	    Antioch::if_else(is_nonzero, dRbkwd_dX,
                              Antioch::zero_clone(keq));
         }
 
-      net_reaction_rate -= kbkwd_times_products;
+      for (unsigned int po=0; po< this->n_products(); po++)
+        {
+          StateType dRbkwd_dX =
+            kbkwd * ( static_cast<CoeffType>(this->product_stoichiometric_coefficient(po))*
+                      concentration_power_minus_one( molar_densities[this->product_id(po)],
+                                                     this->product_partial_order_type(po),
+                                                     this->product_partial_order(po))
+                    );
 
-      dnet_rate_dT -= dRbkwd_dT;
+          for (unsigned int pi=0; pi<this->n_products(); pi++)
+            {
+              if (pi != po)
+                dRbkwd_dX *= concentration_power( molar_densities[this->product_id(pi)],
+                                                  this->product_partial_order_type(pi),
+                                                  this->product_partial_order(pi));
+            }
 
-      for (unsigned int s = 0; s < this->n_species(); s++)
-        {
-          dnet_rate_dX_s[s] -= dRbkwd_dX_s[s];
+          dnet_rate_dX_s[this->product_id(po)] -=
+	    Antioch::if_else(is_nonzero, dRbkwd_dX,
+                             Antioch::zero_clone(keq));
         }
 
+      net_reaction_rate -= kbkwd_times_products;
+
+      dnet_rate_dT -= dRbkwd_dT;
+
     } //end of if(_reversible) condition
 
     return;
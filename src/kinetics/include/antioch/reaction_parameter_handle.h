@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_REACTION_PARAMETER_HANDLE_H
+#define ANTIOCH_REACTION_PARAMETER_HANDLE_H
+
+// Antioch
+#include "antioch/kinetics_enum.h"
+#include "antioch/reaction_enum.h"
+
+// C++
+#include <limits>
+
+namespace Antioch
+{
+  //! Resolved address of a reaction parameter
+  /*!\class ReactionParameterHandle
+   *
+   * Built by ReactionSet::parameter_handle() from a reaction id and
+   * the keywords of ReactionSet::set_parameter_of_reaction(),
+   * it keeps everything this translation yields: the index of the
+   * reaction, the parameter enum, the rate or species it applies to
+   * and the factor from the given unit to the internal one.
+   * ReactionSet::set_parameter() then needs no string processing,
+   * which is what sampling loops updating many parameters many
+   * times want.
+   *
+   * A handle refers to the reaction by its index, it is thus invalidated
+   * by ReactionSet::remove_reaction().
+   */
+  template<typename CoeffType=double>
+  class ReactionParameterHandle
+  {
+  public:
+
+    ReactionParameterHandle();
+
+    ~ReactionParameterHandle();
+
+    //! index of the reaction in the set
+    unsigned int reaction;
+
+    //! kinetics parameter, NOT_FOUND for a chemical process parameter
+    KineticsModel::Parameters kinetics_parameter;
+
+    //! chemical process parameter, NOT_FOUND for a kinetics parameter
+    ReactionType::Parameters chemical_parameter;
+
+    //! index of the rate constant (duplicate and falloff reactions)
+    unsigned int rate;
+
+    //! index in a vectorized parameter, negative if the parameter is a scalar
+    int l;
+
+    //! species of a species dependent chemical process parameter
+    unsigned int species;
+
+    //! factor from the user unit to the internal one
+    CoeffType factor;
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+
+  template<typename CoeffType>
+  inline
+  ReactionParameterHandle<CoeffType>::ReactionParameterHandle()
+    : reaction(std::numeric_limits<unsigned int>::max()),
+      kinetics_parameter(KineticsModel::Parameters::NOT_FOUND),
+      chemical_parameter(ReactionType::Parameters::NOT_FOUND),
+      rate(0),
+      l(-1),
+      species(std::numeric_limits<unsigned int>::max()),
+      factor(1)
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  ReactionParameterHandle<CoeffType>::~ReactionParameterHandle()
+  {
+    return;
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_REACTION_PARAMETER_HANDLE_H
@@ -40,13 +40,19 @@
 #include "antioch/lindemann_falloff.h"
 #include "antioch/troe_falloff.h"
 #include "antioch/string_utils.h"
+#include "antioch/kinetics_workspace.h"
+#include "antioch/temp_cache.h"
+#include "antioch/reaction_parameter_handle.h"
 
 // C++
 #include <iostream>
 #include <fstream>
 #include <iomanip>
 #include <vector>
+#include <unordered_map>
 #include <limits>
+#include <algorithm>
+#include <cstdlib>
 
 namespace Antioch
 {
@@ -90,6 +96,8 @@ namespace Antioch
     Reaction<CoeffType>& reaction(const unsigned int r);
 
     //! \returns the index of a reaction given its id
+    /*! The ids are indexed when the reactions are added, a reaction
+     *  renamed afterwards is still found, by a linear search. */
     unsigned int reaction_by_id(const std::string & reaction_id) const;
 
     //! change a parameter of a reaction
@@ -103,6 +111,25 @@ namespace Antioch
     // in charge of the human-to-antioch translation
     CoeffType get_parameter_of_reaction(const std::string & reaction_id, const std::vector<std::string> & keywords) const;
 
+    //! \return the handle of a parameter of a reaction
+    //
+    // Does once the human-to-antioch translation of set_parameter_of_reaction,
+    // the handle is then used with set_parameter() or set_parameters().
+    ReactionParameterHandle<CoeffType> parameter_handle(const std::string & reaction_id, const std::vector<std::string> & keywords) const;
+
+    //! change the parameter of \p handle, \p value being in the unit given to parameter_handle()
+    void set_parameter(const ReactionParameterHandle<CoeffType> & handle, CoeffType value);
+
+    //! \return the parameter of \p handle, in the unit given to parameter_handle()
+    CoeffType get_parameter(const ReactionParameterHandle<CoeffType> & handle) const;
+
+    //! change the parameters of \p handles, in bulk
+    //
+    // A CompiledReactionSet built on this set needs to be compiled again
+    // to see the changes.
+    template <typename VectorParamType>
+    void set_parameters(const std::vector<ReactionParameterHandle<CoeffType> > & handles, const VectorParamType & values);
+
     const ChemicalMixture<CoeffType>& chemical_mixture() const;
 
     //! Compute the rates of progress for each reaction
@@ -112,6 +139,55 @@ namespace Antioch
                                  const VectorStateType& h_RT_minus_s_R,
                                  VectorReactionsType& net_reaction_rates ) const;
 
+    //! Same as above, using the scratch space of \p workspace.
+    /*! The equilibrium constants are computed by compute_equilibrium_constants(),
+     *  the rates thus agree with the ones of the overload above up to rounding. */
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType, typename WorkspaceVectorType>
+    void compute_reaction_rates( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                 const VectorStateType& molar_densities,
+                                 const VectorStateType& h_RT_minus_s_R,
+                                 VectorReactionsType& net_reaction_rates,
+                                 KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const;
+
+    //! Same as above, for the listed \p reactions only
+    /*! The other entries of \p net_reaction_rates are left untouched,
+     *  see ActiveReactions. */
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType, typename WorkspaceVectorType>
+    void compute_reaction_rates( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                 const VectorStateType& molar_densities,
+                                 const VectorStateType& h_RT_minus_s_R,
+                                 const std::vector<unsigned int>& reactions,
+                                 VectorReactionsType& net_reaction_rates,
+                                 KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const;
+
+    //! Number of forward rate constants, summed over the reactions
+    unsigned int n_rate_constants() const;
+
+    //! Compute the rates of progress and their rate constants parameters derivatives
+    /*!
+     * The rate constants are numbered reaction by reaction, and within
+     * a reaction as Reaction::forward_rate(). For the rate constant \f$i\f$
+     * of the reaction \f$r\f$, \p dnet_rate_dlnA[i] is
+     * \f$\frac{\partial R_r}{\partial \ln A_i}\f$ and \p dnet_rate_dEa[i] is
+     * \f$\frac{\partial R_r}{\partial E_{a,i}}\f$, with \f$E_{a,i}\f$ in J/mol
+     * (zero for the kinetics models without activation energy, and
+     * \f$\frac{\partial R_r}{\partial \ln A_i}\f$ is zero for the photochemical ones).
+     * Both are obtained from the rate of progress and
+     * Reaction::compute_forward_rate_coefficient_log_sensitivities(), in one pass
+     * over the reactions. The reverse rate constant follows the forward one
+     * through the equilibrium constant; an explicit reverse rate constant is not
+     * a parameter here.
+     */
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType,
+              typename VectorParamsType, typename WorkspaceVectorType>
+    void compute_rate_of_progress_sensitivities( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                 const VectorStateType& molar_densities,
+                                                 const VectorStateType& h_RT_minus_s_R,
+                                                 VectorReactionsType& net_reaction_rates,
+                                                 VectorParamsType& dnet_rate_dlnA,
+                                                 VectorParamsType& dnet_rate_dEa,
+                                                 KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const;
+
     //! Compute the rates of progress and derivatives for each reaction
     template <typename StateType, typename VectorStateType, typename VectorReactionsType, typename MatrixReactionsType>
     void compute_reaction_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
@@ -122,6 +198,65 @@ namespace Antioch
                                             VectorReactionsType& dnet_rate_dT,
                                             MatrixReactionsType& dnet_rate_dX_s ) const;
 
+    //! Same as above, using the scratch space of \p workspace: no allocation.
+    template <typename StateType, typename VectorStateType, typename VectorReactionsType, typename MatrixReactionsType>
+    void compute_reaction_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                            const VectorStateType& molar_densities,
+                                            const VectorStateType& h_RT_minus_s_R,
+                                            const VectorStateType& dh_RT_minus_s_R_dT,
+                                            VectorReactionsType& net_reaction_rates,
+                                            VectorReactionsType& dnet_rate_dT,
+                                            MatrixReactionsType& dnet_rate_dX_s,
+                                            KineticsWorkspace<StateType,VectorStateType>& workspace ) const;
+
+    //! Compute the equilibrium constants of the reversible reactions
+    /*!
+     * \f$\exp(-h_RT_minus_s_R_s)\f$ is computed once per species and
+     * \f$\left(\frac{P_0}{RT}\right)^\gamma\f$ once per value of \f$\gamma\f$,
+     * each equilibrium constant being then a product of those. This takes
+     * n_species + 2 exponentials instead of one exponential and one power
+     * per reversible reaction. The entries of \p keq of the irreversible
+     * reactions, and of the ones with an explicit reverse rate, are not set.
+     */
+    template <typename StateType, typename VectorStateType, typename WorkspaceVectorType>
+    void compute_equilibrium_constants( const StateType& P0_RT,
+                                        const VectorStateType& h_RT_minus_s_R,
+                                        std::vector<StateType>& keq,
+                                        KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const;
+
+    //! Same as above, with the temperature derivatives
+    template <typename StateType, typename VectorStateType, typename WorkspaceVectorType>
+    void compute_equilibrium_constants_and_derivs( const StateType& T,
+                                                   const StateType& P0_RT,
+                                                   const VectorStateType& h_RT_minus_s_R,
+                                                   const VectorStateType& dh_RT_minus_s_R_dT,
+                                                   std::vector<StateType>& keq,
+                                                   std::vector<StateType>& dkeq_dT,
+                                                   KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const;
+
+    //! Fit explicit reverse rate constants to \f$\frac{k_f}{K_{eq}}\f$
+    /*!
+     * Each reversible elementary, duplicate or three-body reaction without
+     * a reverse rate yet is given a Kooij reverse rate constant
+     * \f$A_rT^{\beta_r}\exp\left(-\frac{E_r}{T}\right)\f$, fitted by least
+     * squares on \f$\ln(k)\f$ at \p n_points temperatures uniformly spaced
+     * in \f$\ln(T)\f$ between \p T_min and \p T_max, \p thermo giving the
+     * equilibrium constants. These reactions then do not need their
+     * equilibrium constants anymore.
+     *
+     * The largest error of the fits, estimated at the nodes and between
+     * them, is given by reverse_rate_fit_error(). The fits are not updated
+     * if the forward rates are changed afterwards.
+     */
+    template <typename ThermoEvaluator>
+    void fit_reverse_rates( const ThermoEvaluator& thermo,
+                            const CoeffType T_min,
+                            const CoeffType T_max,
+                            const unsigned int n_points );
+
+    //! Largest error in \f$\ln(k)\f$ of the fitted reverse rate constants
+    CoeffType reverse_rate_fit_error() const;
+
     //!
     template <typename StateType, typename VectorStateType>
     void print_chemical_scheme( std::ostream& output,
@@ -178,13 +313,27 @@ namespace Antioch
     // This function is used for both getter and setter.
     void find_chemical_process_parameter(ReactionType::Parameters paramChem ,const std::vector<std::string> & keywords, unsigned int & species) const;
 
+    //! helper function
+    //
+    // Fills the species factors and the powers of the pressure factor
+    // of the equilibrium constants in \p workspace.
+    template <typename StateType, typename VectorStateType, typename WorkspaceVectorType>
+    void compute_equilibrium_factors( const StateType& P0_RT,
+                                      const VectorStateType& h_RT_minus_s_R,
+                                      KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const;
+
     const ChemicalMixture<CoeffType>& _chem_mixture;
 
     std::vector<Reaction<CoeffType>* > _reactions;
 
+    //! Index of the reactions by id, first reaction for duplicated ids
+    std::unordered_map<std::string,unsigned int> _reaction_ids;
+
     //! Scaling for equilibrium constant
     const CoeffType _P0_R;
 
+    CoeffType _reverse_rate_fit_error;
+
   };
 
   /* ------------------------- Inline Functions -------------------------*/
@@ -211,6 +360,8 @@ namespace Antioch
     // and make sure it is initialized!
     _reactions.back()->initialize(_reactions.size() - 1);
 
+    _reaction_ids.insert(std::make_pair(reaction->id(),_reactions.size() - 1));
+
     return;
   }
 
@@ -225,6 +376,11 @@ namespace Antioch
 
      //second, release the spot
      _reactions.erase(_reactions.begin() + nr);
+
+     //third, the following reactions moved
+     _reaction_ids.clear();
+     for(unsigned int r = 0; r < _reactions.size(); r++)
+       _reaction_ids.insert(std::make_pair(_reactions[r]->id(),r));
   }
 
   template<typename CoeffType>
@@ -255,7 +411,8 @@ namespace Antioch
   inline
   ReactionSet<CoeffType>::ReactionSet( const ChemicalMixture<CoeffType>& chem_mixture )
     : _chem_mixture(chem_mixture),
-      _P0_R(1.0e5/Constants::R_universal<CoeffType>()) //SI
+      _P0_R(1.0e5/Constants::R_universal<CoeffType>()), //SI
+      _reverse_rate_fit_error(0)
   {
     return;
   }
@@ -297,6 +454,147 @@ namespace Antioch
     return;
   }
 
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType, typename WorkspaceVectorType>
+  inline
+  void ReactionSet<CoeffType>::compute_reaction_rates ( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                        const VectorStateType& molar_densities,
+                                                        const VectorStateType& h_RT_minus_s_R,
+                                                        VectorReactionsType& net_reaction_rates,
+                                                        KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const
+  {
+    antioch_assert_equal_to( net_reaction_rates.size(), this->n_reactions() );
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+
+    // useful constants
+    const StateType P0_RT = _P0_R/conditions.T(); // used to transform equilibrium constant from pressure units
+
+    this->compute_equilibrium_constants( P0_RT, h_RT_minus_s_R, workspace.keq, workspace );
+
+    // compute reaction forward rates & other reaction-sized arrays
+    for (unsigned int rxn=0; rxn<this->n_reactions(); rxn++)
+      {
+        net_reaction_rates[rxn] = this->reaction(rxn).compute_rate_of_progress(molar_densities, conditions, workspace.keq[rxn]);
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType, typename WorkspaceVectorType>
+  inline
+  void ReactionSet<CoeffType>::compute_reaction_rates ( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                        const VectorStateType& molar_densities,
+                                                        const VectorStateType& h_RT_minus_s_R,
+                                                        const std::vector<unsigned int>& reactions,
+                                                        VectorReactionsType& net_reaction_rates,
+                                                        KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const
+  {
+    antioch_assert_equal_to( net_reaction_rates.size(), this->n_reactions() );
+    antioch_assert_equal_to( molar_densities.size(), this->n_species() );
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+
+    if( reactions.empty() )
+      return;
+
+    // useful constants
+    const StateType P0_RT = _P0_R/conditions.T(); // used to transform equilibrium constant from pressure units
+
+    // the species terms are shared, all the constants are computed
+    this->compute_equilibrium_constants( P0_RT, h_RT_minus_s_R, workspace.keq, workspace );
+
+    for (unsigned int i=0; i<reactions.size(); i++)
+      {
+        const unsigned int rxn = reactions[i];
+        antioch_assert_less( rxn, this->n_reactions() );
+        net_reaction_rates[rxn] = this->reaction(rxn).compute_rate_of_progress(molar_densities, conditions, workspace.keq[rxn]);
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int ReactionSet<CoeffType>::n_rate_constants() const
+  {
+    unsigned int n(0);
+    for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+      n += this->reaction(rxn).n_rate_constants();
+
+    return n;
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType,
+           typename VectorParamsType, typename WorkspaceVectorType>
+  inline
+  void ReactionSet<CoeffType>::compute_rate_of_progress_sensitivities( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                       const VectorStateType& molar_densities,
+                                                                       const VectorStateType& h_RT_minus_s_R,
+                                                                       VectorReactionsType& net_reaction_rates,
+                                                                       VectorParamsType& dnet_rate_dlnA,
+                                                                       VectorParamsType& dnet_rate_dEa,
+                                                                       KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const
+  {
+    antioch_assert_equal_to( dnet_rate_dlnA.size(), this->n_rate_constants() );
+    antioch_assert_equal_to( dnet_rate_dEa.size(), this->n_rate_constants() );
+
+    this->compute_reaction_rates( conditions, molar_densities, h_RT_minus_s_R, net_reaction_rates, workspace );
+
+    // d ln k / d Ea for Ea in J/mol
+    const StateType minus_one_over_RT = Antioch::constant_clone(conditions.T(),-1) /
+                                        (Constants::R_universal<CoeffType>() * conditions.T());
+
+    unsigned int i(0);
+    for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+      {
+        const Reaction<CoeffType>& reaction = this->reaction(rxn);
+
+        // the part of the rate of progress proportional to the forward rate coefficient
+        StateType R = net_reaction_rates[rxn];
+        if( reaction.reversible() && reaction.has_reverse_rate() )
+          {
+            StateType kbkwd_times_products = reaction.compute_reverse_rate_coefficient(molar_densities,conditions);
+            for (unsigned int p=0; p < reaction.n_products(); p++)
+              kbkwd_times_products *= concentration_power( molar_densities[reaction.product_id(p)],
+                                                           reaction.product_partial_order_type(p),
+                                                           reaction.product_partial_order(p) );
+            R += kbkwd_times_products;
+          }
+
+        reaction.compute_forward_rate_coefficient_log_sensitivities( molar_densities, conditions, workspace.dlnkfwd_dlnk );
+
+        for (unsigned int ir=0; ir < reaction.n_rate_constants(); ir++, i++)
+          {
+            dnet_rate_dlnA[i] = workspace.dlnkfwd_dlnk[ir] * R;
+
+            switch( reaction.forward_rate(ir).type() )
+              {
+              case(KineticsModel::ARRHENIUS):
+              case(KineticsModel::KOOIJ):
+              case(KineticsModel::VANTHOFF):
+                {
+                  dnet_rate_dEa[i] = minus_one_over_RT * dnet_rate_dlnA[i];
+                }
+                break;
+              case(KineticsModel::PHOTOCHEM):
+                {
+                  dnet_rate_dlnA[i] = Antioch::zero_clone(R);
+                  dnet_rate_dEa[i] = Antioch::zero_clone(R);
+                }
+                break;
+              default:
+                {
+                  dnet_rate_dEa[i] = Antioch::zero_clone(R);
+                }
+              }
+          }
+      }
+
+    return;
+  }
+
   template<typename CoeffType>
   template<typename StateType, typename VectorStateType, typename VectorReactionsType, typename MatrixReactionsType>
   inline
@@ -307,6 +605,25 @@ namespace Antioch
                                                                   VectorReactionsType& net_reaction_rates,
                                                                   VectorReactionsType& dnet_rate_dT,
                                                                   MatrixReactionsType& dnet_rate_dX_s ) const
+  {
+    KineticsWorkspace<StateType,VectorStateType> workspace(*this, conditions.T());
+
+    this->compute_reaction_rates_and_derivs( conditions, molar_densities, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
+                                             net_reaction_rates, dnet_rate_dT, dnet_rate_dX_s,
+                                             workspace );
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename VectorReactionsType, typename MatrixReactionsType>
+  inline
+  void ReactionSet<CoeffType>::compute_reaction_rates_and_derivs( const KineticsConditions<StateType,VectorStateType>& conditions,
+                                                                  const VectorStateType& molar_densities,
+                                                                  const VectorStateType& h_RT_minus_s_R,
+                                                                  const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                  VectorReactionsType& net_reaction_rates,
+                                                                  VectorReactionsType& dnet_rate_dT,
+                                                                  MatrixReactionsType& dnet_rate_dX_s,
+                                                                  KineticsWorkspace<StateType,VectorStateType>& workspace ) const
   {
     antioch_assert_equal_to( net_reaction_rates.size(), this->n_reactions() );
     antioch_assert_equal_to( dnet_rate_dT.size(), this->n_reactions() );
@@ -335,17 +652,292 @@ namespace Antioch
                                                                       conditions, P0_RT, h_RT_minus_s_R, dh_RT_minus_s_R_dT,
                                                                       net_reaction_rates[rxn],
                                                                       dnet_rate_dT[rxn],
-                                                                      dnet_rate_dX_s[rxn] );
+                                                                      dnet_rate_dX_s[rxn],
+                                                                      workspace.dkfwd_dX_s );
       }
 
     return;
   }
 
 
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename WorkspaceVectorType>
+  inline
+  void ReactionSet<CoeffType>::compute_equilibrium_factors( const StateType& P0_RT,
+                                                            const VectorStateType& h_RT_minus_s_R,
+                                                            KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const
+  {
+    antioch_assert_equal_to( workspace.species_exp.size(), this->n_species() );
+    antioch_assert_equal_to( workspace.P0_RT_powers.size() % 2, 1 );
+
+    // The species factors are scaled by exp(mean) to stay away from
+    // under- and overflows. As gamma is the sum of the net stoichiometric
+    // coefficients, the powers of P0_RT/exp(mean) compensate for it.
+    StateType mean = Antioch::zero_clone(P0_RT);
+    for (unsigned int s=0; s < this->n_species(); s++)
+      {
+        mean += h_RT_minus_s_R[s];
+      }
+    mean /= static_cast<CoeffType>(std::max(this->n_species(),1u));
+
+    for (unsigned int s=0; s < this->n_species(); s++)
+      {
+        workspace.species_exp[s] = ant_exp(mean - h_RT_minus_s_R[s]);
+      }
+
+    const unsigned int max_gamma = (workspace.P0_RT_powers.size() - 1)/2;
+    const StateType factor = P0_RT * ant_exp(-mean);
+    const StateType inv_factor = Antioch::constant_clone(P0_RT,1)/factor;
+
+    workspace.P0_RT_powers[max_gamma] = Antioch::constant_clone(P0_RT,1);
+    for (unsigned int g=1; g <= max_gamma; g++)
+      {
+        workspace.P0_RT_powers[max_gamma + g] = workspace.P0_RT_powers[max_gamma + g - 1] * factor;
+        workspace.P0_RT_powers[max_gamma - g] = workspace.P0_RT_powers[max_gamma - g + 1] * inv_factor;
+      }
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename WorkspaceVectorType>
+  inline
+  void ReactionSet<CoeffType>::compute_equilibrium_constants( const StateType& P0_RT,
+                                                              const VectorStateType& h_RT_minus_s_R,
+                                                              std::vector<StateType>& keq,
+                                                              KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const
+  {
+    antioch_assert_equal_to( h_RT_minus_s_R.size(), this->n_species() );
+    antioch_assert_equal_to( keq.size(), this->n_reactions() );
+
+    // nothing to do if all the reverse rates are explicit
+    bool needed(false);
+    for (unsigned int rxn=0; rxn < this->n_reactions() && !needed; rxn++)
+      {
+        needed = this->reaction(rxn).reversible() && !this->reaction(rxn).has_reverse_rate();
+      }
+    if(!needed)
+      return;
+
+    this->compute_equilibrium_factors( P0_RT, h_RT_minus_s_R, workspace );
+
+    const int max_gamma = (workspace.P0_RT_powers.size() - 1)/2;
+    const std::vector<StateType>& species_exp = workspace.species_exp;
+
+    // K = (P0/(RT))^gamma prod_s exp(-h_RT_minus_s_R[s])^(nu_p - nu_r)
+    for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+      {
+        const Reaction<CoeffType>& reaction = this->reaction(rxn);
+        if( !reaction.reversible() || reaction.has_reverse_rate() )
+          continue;
+
+        antioch_assert_less_equal( std::abs(reaction.gamma()), max_gamma );
+
+        StateType products = workspace.P0_RT_powers[max_gamma + reaction.gamma()];
+        for (unsigned int p=0; p < reaction.n_products(); p++)
+          {
+            for (unsigned int n=0; n < reaction.product_stoichiometric_coefficient(p); n++)
+              products *= species_exp[reaction.product_id(p)];
+          }
+
+        StateType reactants = Antioch::constant_clone(P0_RT,1);
+        for (unsigned int r=0; r < reaction.n_reactants(); r++)
+          {
+            for (unsigned int n=0; n < reaction.reactant_stoichiometric_coefficient(r); n++)
+              reactants *= species_exp[reaction.reactant_id(r)];
+          }
+
+        keq[rxn] = products/reactants;
+      }
+  }
+
+  template<typename CoeffType>
+  template<typename StateType, typename VectorStateType, typename WorkspaceVectorType>
+  inline
+  void ReactionSet<CoeffType>::compute_equilibrium_constants_and_derivs( const StateType& T,
+                                                                         const StateType& P0_RT,
+                                                                         const VectorStateType& h_RT_minus_s_R,
+                                                                         const VectorStateType& dh_RT_minus_s_R_dT,
+                                                                         std::vector<StateType>& keq,
+                                                                         std::vector<StateType>& dkeq_dT,
+                                                                         KineticsWorkspace<StateType,WorkspaceVectorType>& workspace ) const
+  {
+    antioch_assert_equal_to( dh_RT_minus_s_R_dT.size(), this->n_species() );
+    antioch_assert_equal_to( dkeq_dT.size(), this->n_reactions() );
+
+    this->compute_equilibrium_constants( P0_RT, h_RT_minus_s_R, keq, workspace );
+
+    // dK/dT = K (-gamma/T + sum_r nu_r dh_r - sum_p nu_p dh_p)
+    for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+      {
+        const Reaction<CoeffType>& reaction = this->reaction(rxn);
+        if( !reaction.reversible() || reaction.has_reverse_rate() )
+          continue;
+
+        StateType ddT_exppower = - static_cast<CoeffType>(reaction.gamma())/T;
+        for (unsigned int r=0; r < reaction.n_reactants(); r++)
+          {
+            ddT_exppower += static_cast<CoeffType>(reaction.reactant_stoichiometric_coefficient(r)) *
+                            dh_RT_minus_s_R_dT[reaction.reactant_id(r)];
+          }
+        for (unsigned int p=0; p < reaction.n_products(); p++)
+          {
+            ddT_exppower -= static_cast<CoeffType>(reaction.product_stoichiometric_coefficient(p)) *
+                            dh_RT_minus_s_R_dT[reaction.product_id(p)];
+          }
+
+        dkeq_dT[rxn] = keq[rxn] * ddT_exppower;
+      }
+  }
+
+  template<typename CoeffType>
+  template<typename ThermoEvaluator>
+  inline
+  void ReactionSet<CoeffType>::fit_reverse_rates( const ThermoEvaluator& thermo,
+                                                  const CoeffType T_min,
+                                                  const CoeffType T_max,
+                                                  const unsigned int n_points )
+  {
+    antioch_assert_greater( T_min, 0 );
+    antioch_assert_less( T_min, T_max );
+    antioch_assert_greater_equal( n_points, 3 );
+
+    // the nodes, and the midpoints where the errors are estimated
+    const unsigned int n_T = 2*n_points - 1;
+    const CoeffType ln_T_min = ant_log(T_min);
+    const CoeffType ln_T_max = ant_log(T_max);
+
+    std::vector<CoeffType> T(n_T);
+    std::vector<CoeffType> lnT(n_T);
+    std::vector<std::vector<CoeffType> > h_RT_minus_s_R(n_T, std::vector<CoeffType>(this->n_species()));
+    for (unsigned int i=0; i < n_T; i++)
+      {
+        lnT[i] = ln_T_min + (i * (ln_T_max - ln_T_min))/(n_T - 1);
+
+        // exp(ln(T_max)) may round above T_max, and out of the thermo fits
+        T[i] = std::max(T_min, std::min(T_max, CoeffType(ant_exp(lnT[i]))));
+        const TempCache<CoeffType> cache(T[i]);
+        thermo.h_RT_minus_s_R(cache,h_RT_minus_s_R[i]);
+      }
+
+    // ln(k) = a_0 + a_1 u + a_2 v, u and v being ln(T) and 1/T
+    // mapped to [-1,1] for the normal equations to be well conditioned
+    const CoeffType pu = 2/(ln_T_max - ln_T_min);
+    const CoeffType qu = - 1 - pu * ln_T_min;
+    const CoeffType pv = 2/(1/T_min - 1/T_max);
+    const CoeffType qv = - 1 - pv/T_max;
+
+    CoeffType N[3][3] = {{0,0,0},{0,0,0},{0,0,0}};
+    for (unsigned int i=0; i < n_T; i += 2)
+      {
+        const CoeffType phi[3] = {1, pu * lnT[i] + qu, pv/T[i] + qv};
+        for (unsigned int j=0; j < 3; j++)
+          for (unsigned int k=0; k < 3; k++)
+            N[j][k] += phi[j] * phi[k];
+      }
+
+    // inverse of the normal matrix, by its cofactors
+    CoeffType N_inv[3][3];
+    for (unsigned int j=0; j < 3; j++)
+      for (unsigned int k=0; k < 3; k++)
+        N_inv[k][j] = N[(j+1)%3][(k+1)%3] * N[(j+2)%3][(k+2)%3] -
+                      N[(j+1)%3][(k+2)%3] * N[(j+2)%3][(k+1)%3];
+
+    const CoeffType det = N[0][0] * N_inv[0][0] + N[0][1] * N_inv[1][0] + N[0][2] * N_inv[2][0];
+    for (unsigned int j=0; j < 3; j++)
+      for (unsigned int k=0; k < 3; k++)
+        N_inv[j][k] /= det;
+
+    const CoeffType ln_P0_R = ant_log(_P0_R);
+    std::vector<CoeffType> ln_k(n_T);
+
+    _reverse_rate_fit_error = 0;
+
+    for (unsigned int rxn=0; rxn < this->n_reactions(); rxn++)
+      {
+        Reaction<CoeffType>& reaction = this->reaction(rxn);
+
+        if( !reaction.reversible() || reaction.has_reverse_rate() ||
+            reaction.kinetics_model() == KineticsModel::PHOTOCHEM )
+          continue;
+
+        if( reaction.type() != ReactionType::ELEMENTARY &&
+            reaction.type() != ReactionType::DUPLICATE  &&
+            reaction.type() != ReactionType::THREE_BODY )
+          continue;
+
+        // ln(k_f/K_eq), without [M] for three-body reactions
+        bool positive(true);
+        for (unsigned int i=0; i < n_T; i++)
+          {
+            const KineticsConditions<CoeffType> conditions(T[i]);
+
+            CoeffType kfwd = 0;
+            for (unsigned int ir=0; ir < reaction.n_rate_constants(); ir++)
+              {
+                kfwd += reaction.forward_rate(ir)(conditions);
+              }
+            positive = positive && (kfwd > 0);
+
+            CoeffType ln_keq = reaction.gamma() * (ln_P0_R - lnT[i]);
+            for (unsigned int r=0; r < reaction.n_reactants(); r++)
+              {
+                ln_keq += reaction.reactant_stoichiometric_coefficient(r) * h_RT_minus_s_R[i][reaction.reactant_id(r)];
+              }
+            for (unsigned int p=0; p < reaction.n_products(); p++)
+              {
+                ln_keq -= reaction.product_stoichiometric_coefficient(p) * h_RT_minus_s_R[i][reaction.product_id(p)];
+              }
+
+            ln_k[i] = ant_log(kfwd) - ln_keq;
+          }
+
+        // ln(0) cannot be fitted
+        if(!positive)
+          continue;
+
+        CoeffType rhs[3] = {0,0,0};
+        for (unsigned int i=0; i < n_T; i += 2)
+          {
+            rhs[0] += ln_k[i];
+            rhs[1] += (pu * lnT[i] + qu) * ln_k[i];
+            rhs[2] += (pv/T[i] + qv) * ln_k[i];
+          }
+
+        CoeffType a[3] = {0,0,0};
+        for (unsigned int j=0; j < 3; j++)
+          for (unsigned int k=0; k < 3; k++)
+            a[j] += N_inv[j][k] * rhs[k];
+
+        // back to ln(A_r) + beta_r ln(T) - E_r/T
+        const CoeffType ln_A = a[0] + a[1] * qu + a[2] * qv;
+        const CoeffType beta = a[1] * pu;
+        const CoeffType Ea   = - a[2] * pv;
+
+        for (unsigned int i=0; i < n_T; i++)
+          {
+            _reverse_rate_fit_error = std::max(_reverse_rate_fit_error,
+                                               ant_abs(ln_A + beta * lnT[i] - Ea/T[i] - ln_k[i]));
+          }
+
+        reaction.set_reverse_rate(new KooijRate<CoeffType>(ant_exp(ln_A), beta, Ea, 1, 1));
+      }
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType ReactionSet<CoeffType>::reverse_rate_fit_error() const
+  {
+    return _reverse_rate_fit_error;
+  }
+
   template<typename CoeffType>
   inline
   unsigned int ReactionSet<CoeffType>::reaction_by_id(const std::string & reaction_id) const
   {
+      typename std::unordered_map<std::string,unsigned int>::const_iterator it = _reaction_ids.find(reaction_id);
+      if(it != _reaction_ids.end() && this->reaction(it->second).id() == reaction_id)
+        return it->second;
+
+      // renamed since added
       unsigned int r(0);
       for(r = 0; r < this->n_reactions(); r++)
       {
@@ -550,6 +1142,98 @@ namespace Antioch
 
   }
 
+  template<typename CoeffType>
+  inline
+  ReactionParameterHandle<CoeffType> ReactionSet<CoeffType>::parameter_handle(const std::string & reaction_id, const std::vector<std::string> & keywords) const
+  {
+     antioch_assert(keywords.size()); // not zero
+
+     ReactionParameterHandle<CoeffType> handle;
+
+     handle.reaction = this->reaction_by_id(reaction_id);
+
+     handle.kinetics_parameter = string_to_kin_enum(keywords[0]);
+     handle.chemical_parameter = string_to_chem_enum(keywords[0]);
+
+     if(handle.kinetics_parameter != KineticsModel::Parameters::NOT_FOUND)
+     {
+          std::string unit("SI"); // default internal parameter unit system
+
+          this->find_kinetics_model_parameter(handle.reaction,keywords,handle.rate,unit,handle.l);
+
+          antioch_assert_less(handle.rate,this->reaction(handle.reaction).n_rate_constants());
+
+          handle.factor = rate_parameter_unit_factor<CoeffType>(handle.kinetics_parameter,unit);
+
+     }else if(handle.chemical_parameter != ReactionType::Parameters::NOT_FOUND)
+     {
+          this->find_chemical_process_parameter(handle.chemical_parameter, keywords, handle.species);
+     }else
+     {
+         antioch_error();
+     }
+
+     return handle;
+  }
+
+  template<typename CoeffType>
+  inline
+  void ReactionSet<CoeffType>::set_parameter(const ReactionParameterHandle<CoeffType> & handle, CoeffType value)
+  {
+     antioch_assert_less(handle.reaction,this->n_reactions());
+
+     Reaction<CoeffType> & reaction = this->reaction(handle.reaction);
+
+     if(handle.kinetics_parameter != KineticsModel::Parameters::NOT_FOUND)
+     {
+          (handle.l < 0)?set_internal_parameter_of_rate(reaction.forward_rate(handle.rate), handle.kinetics_parameter, value * handle.factor):
+                         set_internal_parameter_of_rate(reaction.forward_rate(handle.rate), handle.kinetics_parameter, value * handle.factor, handle.l);
+     }else
+     {
+          reaction.set_parameter_of_chemical_process(handle.chemical_parameter, value, handle.species);
+     }
+  }
+
+  template<typename CoeffType>
+  inline
+  CoeffType ReactionSet<CoeffType>::get_parameter(const ReactionParameterHandle<CoeffType> & handle) const
+  {
+     antioch_assert_less(handle.reaction,this->n_reactions());
+
+     const Reaction<CoeffType> & reaction = this->reaction(handle.reaction);
+
+     CoeffType parameter;
+     if(handle.kinetics_parameter != KineticsModel::Parameters::NOT_FOUND)
+     {
+          const KineticsType<CoeffType> & rate = reaction.forward_rate(handle.rate);
+          parameter = (handle.l < 0)?rate.get_parameter(handle.kinetics_parameter):
+                                     rate.get_parameter(handle.kinetics_parameter, handle.l);
+
+          // the rates give back the activation energy in their own unit,
+          // the handle factor is about the reduced one, in K
+          if(handle.kinetics_parameter == KineticsModel::Parameters::E)
+            parameter /= rate.get_parameter(KineticsModel::Parameters::R_SCALE);
+
+          parameter /= handle.factor;
+     }else
+     {
+          parameter = reaction.get_parameter_of_chemical_process(handle.chemical_parameter, handle.species);
+     }
+
+     return parameter;
+  }
+
+  template<typename CoeffType>
+  template <typename VectorParamType>
+  inline
+  void ReactionSet<CoeffType>::set_parameters(const std::vector<ReactionParameterHandle<CoeffType> > & handles, const VectorParamType & values)
+  {
+     antioch_assert_equal_to(handles.size(),values.size());
+
+     for(unsigned int i = 0; i < handles.size(); i++)
+       this->set_parameter(handles[i], values[i]);
+  }
+
   template<typename CoeffType>
   template<typename StateType, typename VectorStateType>
   inline
@@ -836,21 +1520,28 @@ namespace Antioch
 
         for (unsigned int r=0; r<reaction.n_reactants(); r++)
           {
-            fwd_conc[rxn] *= pow( molar_densities[reaction.reactant_id(r)],
-                              reaction.reactant_partial_order(r));
+            fwd_conc[rxn] *= concentration_power( molar_densities[reaction.reactant_id(r)],
+                                                  reaction.reactant_partial_order_type(r),
+                                                  reaction.reactant_partial_order(r));
           }
         kfwd[rxn] *= fwd_conc[rxn];
 
         if(reaction.reversible())
         {
-          StateType keq = reaction.equilibrium_constant( P0_RT, h_RT_minus_s_R );
-
-          kbkwd_const[rxn] = kfwd_const[rxn]/keq;
+          if(reaction.has_reverse_rate())
+            {
+              kbkwd_const[rxn] = reaction.compute_reverse_rate_coefficient(molar_densities,conditions);
+            }
+          else
+            {
+              kbkwd_const[rxn] = kfwd_const[rxn]/reaction.equilibrium_constant( P0_RT, h_RT_minus_s_R );
+            }
           kbkwd[rxn] = kbkwd_const[rxn];
           for (unsigned int p=0; p<reaction.n_products(); p++)
             {
-              bkwd_conc[rxn] *= pow( molar_densities[reaction.product_id(p)],
-                                  reaction.product_partial_order(p));
+              bkwd_conc[rxn] *= concentration_power( molar_densities[reaction.product_id(p)],
+                                                     reaction.product_partial_order_type(p),
+                                                     reaction.product_partial_order(p));
             }
           kbkwd[rxn] *= bkwd_conc[rxn];
         }
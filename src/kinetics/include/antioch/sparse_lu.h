@@ -0,0 +1,391 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+
+#ifndef ANTIOCH_SPARSE_LU_H
+#define ANTIOCH_SPARSE_LU_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/kinetics_jacobian_pattern.h"
+
+// C++
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+
+namespace Antioch
+{
+
+  //! Sparse LU factorization for a fixed nonzero pattern
+  /*!\class SparseLU
+   *
+   * Direct solver for the linear systems of implicit chemistry integrators,
+   * whose matrices (e.g. \f$I/(h\gamma) - J\f$) keep the nonzero pattern
+   * of the source terms Jacobian from one Newton step to the next.
+   *
+   * The symbolic analysis is done once, at construction: a minimum degree
+   * ordering of the symmetrized pattern \f$A + A^T\f$ reduces the fill-in,
+   * and the elimination gives the pattern of the factors. factorize() then
+   * only does the numerical work, in place over that pattern.
+   *
+   * The ordering is static: there is no numerical pivoting and factorize()
+   * fails on a zero pivot. This is safe for the diagonally dominated
+   * iteration matrices of stiff integrators at reasonable step sizes, and
+   * a failure can be handled like a singular matrix, by reducing the step.
+   */
+  template<typename CoeffType=double>
+  class SparseLU
+  {
+  public:
+
+    //! Constructor, from the CSR pattern of a n \f$\times\f$ n matrix
+    /*!
+     * The entries of row i are in [row_offsets[i],row_offsets[i+1]);
+     * the diagonal does not need to be part of the pattern.
+     */
+    SparseLU( const unsigned int n,
+              const std::vector<unsigned int>& row_offsets,
+              const std::vector<unsigned int>& column_indices );
+
+    //! Constructor, for the species source terms Jacobian
+    SparseLU( const KineticsJacobianPattern<CoeffType>& pattern );
+
+    ~SparseLU();
+
+    //! \returns the number of rows and columns.
+    unsigned int n() const;
+
+    //! \returns the number of entries of the matrix pattern.
+    unsigned int n_nonzeros() const;
+
+    //! \returns the number of entries of the factors, fill-in included.
+    unsigned int n_factor_nonzeros() const;
+
+    //! Elimination order: row and column permutation()[k] is the k-th one eliminated
+    const std::vector<unsigned int>& permutation() const;
+
+    //! Numerical factorization
+    /*!
+     * \p values has n_nonzeros() entries, in the order of the constructor
+     * pattern (e.g. the output of KineticsJacobianPattern::scatter()).
+     * \returns false if a pivot is zero, in which case the factors are not usable.
+     */
+    template <typename VectorValuesType>
+    bool factorize( const VectorValuesType& values );
+
+    //! Solves in place with the last factorization
+    template <typename VectorType>
+    void solve( VectorType& x );
+
+  protected:
+
+    //! ordering, symbolic factorization and map of the matrix entries
+    void analyze( const std::vector<unsigned int>& row_offsets,
+                  const std::vector<unsigned int>& column_indices );
+
+    unsigned int _n;
+
+    std::vector<unsigned int> _permutation;
+
+    //! factors in CSR form, in the permuted ordering: L (unit diagonal,
+    //  not stored) left of the diagonal, U from the diagonal on
+    std::vector<unsigned int> _lu_offsets;
+    std::vector<unsigned int> _lu_columns;
+    std::vector<unsigned int> _lu_diagonal;
+    std::vector<CoeffType>    _lu_values;
+
+    //! for each matrix entry, its position in _lu_values
+    std::vector<unsigned int> _value_positions;
+
+    //! position of each column in the row being factorized
+    std::vector<unsigned int> _row_positions;
+
+    //! permuted right hand side
+    std::vector<CoeffType> _work;
+
+  private:
+
+    SparseLU();
+
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType>
+  inline
+  SparseLU<CoeffType>::SparseLU( const unsigned int n,
+                                 const std::vector<unsigned int>& row_offsets,
+                                 const std::vector<unsigned int>& column_indices )
+    : _n(n)
+  {
+    this->analyze( row_offsets, column_indices );
+
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  SparseLU<CoeffType>::SparseLU( const KineticsJacobianPattern<CoeffType>& pattern )
+    : _n(pattern.n_species())
+  {
+    this->analyze( pattern.row_offsets(), pattern.column_indices() );
+
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  SparseLU<CoeffType>::~SparseLU()
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  void SparseLU<CoeffType>::analyze( const std::vector<unsigned int>& row_offsets,
+                                     const std::vector<unsigned int>& column_indices )
+  {
+    antioch_assert_equal_to( row_offsets.size(), _n + 1 );
+    antioch_assert_equal_to( column_indices.size(), row_offsets[_n] );
+
+    // symmetrized graph, without the diagonal
+    std::vector<std::vector<unsigned int> > adjacency(_n);
+    for(unsigned int i = 0; i < _n; i++)
+      for(unsigned int q = row_offsets[i]; q < row_offsets[i+1]; q++)
+        {
+          const unsigned int j = column_indices[q];
+          antioch_assert_less( j, _n );
+          if( i != j )
+            {
+              adjacency[i].push_back(j);
+              adjacency[j].push_back(i);
+            }
+        }
+
+    for(unsigned int i = 0; i < _n; i++)
+      {
+        std::sort( adjacency[i].begin(), adjacency[i].end() );
+        adjacency[i].erase( std::unique( adjacency[i].begin(), adjacency[i].end() ), adjacency[i].end() );
+      }
+
+    // minimum degree: eliminating a node makes its remaining neighbours
+    // a clique, and these neighbours are the pattern of its column of L
+    std::vector<std::vector<unsigned int> > eliminated_neighbours(_n);
+    std::vector<bool> eliminated(_n, false);
+    std::vector<unsigned int> merged;
+
+    _permutation.clear();
+    while( _permutation.size() < _n )
+      {
+        const unsigned int n_remaining = _n - _permutation.size();
+
+        unsigned int v = _n;
+        for(unsigned int i = 0; i < _n; i++)
+          if( !eliminated[i] && (v == _n || adjacency[i].size() < adjacency[v].size()) )
+            v = i;
+
+        // the remaining graph is complete: no more fill-in, whatever the order
+        if( adjacency[v].size() + 1 == n_remaining )
+          {
+            for(unsigned int i = 0; i < _n; i++)
+              if( !eliminated[i] )
+                {
+                  eliminated[i] = true;
+                  _permutation.push_back(i);
+                }
+
+            for(unsigned int k = _n - n_remaining; k < _n; k++)
+              eliminated_neighbours[_permutation[k]].assign( _permutation.begin() + k + 1, _permutation.end() );
+
+            break;
+          }
+
+        eliminated[v] = true;
+        _permutation.push_back(v);
+        eliminated_neighbours[v] = adjacency[v];
+
+        for(unsigned int a = 0; a < adjacency[v].size(); a++)
+          {
+            const unsigned int u = adjacency[v][a];
+
+            merged.clear();
+            std::set_union( adjacency[u].begin(), adjacency[u].end(),
+                            adjacency[v].begin(), adjacency[v].end(),
+                            std::back_inserter(merged) );
+            merged.erase( std::remove( merged.begin(), merged.end(), u ), merged.end() );
+            merged.erase( std::remove( merged.begin(), merged.end(), v ), merged.end() );
+            adjacency[u].swap(merged);
+          }
+
+        adjacency[v].clear();
+      }
+
+    std::vector<unsigned int> inverse(_n);
+    for(unsigned int k = 0; k < _n; k++)
+      inverse[_permutation[k]] = k;
+
+    // pattern of the factors, row by row in the permuted ordering
+    std::vector<std::vector<unsigned int> > rows(_n);
+    for(unsigned int k = 0; k < _n; k++)
+      {
+        rows[k].push_back(k);
+        const std::vector<unsigned int>& neighbours = eliminated_neighbours[_permutation[k]];
+        for(unsigned int a = 0; a < neighbours.size(); a++)
+          {
+            const unsigned int i = inverse[neighbours[a]];
+            rows[k].push_back(i); // U_ki
+            rows[i].push_back(k); // L_ik
+          }
+      }
+
+    _lu_offsets.assign(1,0);
+    _lu_columns.clear();
+    _lu_diagonal.resize(_n);
+    for(unsigned int i = 0; i < _n; i++)
+      {
+        std::sort( rows[i].begin(), rows[i].end() );
+        for(unsigned int q = 0; q < rows[i].size(); q++)
+          {
+            if( rows[i][q] == i )
+              _lu_diagonal[i] = _lu_columns.size();
+            _lu_columns.push_back( rows[i][q] );
+          }
+        _lu_offsets.push_back( _lu_columns.size() );
+      }
+
+    _lu_values.resize( _lu_columns.size() );
+
+    // where the matrix entries go
+    _value_positions.resize( column_indices.size() );
+    for(unsigned int i = 0; i < _n; i++)
+      for(unsigned int q = row_offsets[i]; q < row_offsets[i+1]; q++)
+        {
+          const unsigned int row = inverse[i];
+          const std::vector<unsigned int>::const_iterator begin = _lu_columns.begin() + _lu_offsets[row];
+          const std::vector<unsigned int>::const_iterator end   = _lu_columns.begin() + _lu_offsets[row+1];
+          const std::vector<unsigned int>::const_iterator it    = std::lower_bound( begin, end, inverse[column_indices[q]] );
+          antioch_assert( it != end );
+
+          _value_positions[q] = it - _lu_columns.begin();
+        }
+
+    _row_positions.resize(_n);
+    _work.resize(_n);
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int SparseLU<CoeffType>::n() const
+  {
+    return _n;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int SparseLU<CoeffType>::n_nonzeros() const
+  {
+    return _value_positions.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int SparseLU<CoeffType>::n_factor_nonzeros() const
+  {
+    return _lu_columns.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& SparseLU<CoeffType>::permutation() const
+  {
+    return _permutation;
+  }
+
+  template<typename CoeffType>
+  template <typename VectorValuesType>
+  inline
+  bool SparseLU<CoeffType>::factorize( const VectorValuesType& values )
+  {
+    antioch_assert_equal_to( values.size(), this->n_nonzeros() );
+
+    using std::abs;
+
+    std::fill( _lu_values.begin(), _lu_values.end(), CoeffType(0) );
+    for(unsigned int q = 0; q < _value_positions.size(); q++)
+      _lu_values[_value_positions[q]] += values[q];
+
+    // row by row (Doolittle): the pattern is closed under elimination,
+    // so every update of row i lands on one of its entries
+    for(unsigned int i = 0; i < _n; i++)
+      {
+        for(unsigned int q = _lu_offsets[i]; q < _lu_offsets[i+1]; q++)
+          _row_positions[_lu_columns[q]] = q;
+
+        for(unsigned int q = _lu_offsets[i]; q < _lu_diagonal[i]; q++)
+          {
+            const unsigned int k = _lu_columns[q];
+            const CoeffType l = _lu_values[q] / _lu_values[_lu_diagonal[k]];
+            _lu_values[q] = l;
+
+            for(unsigned int p = _lu_diagonal[k] + 1; p < _lu_offsets[k+1]; p++)
+              _lu_values[_row_positions[_lu_columns[p]]] -= l * _lu_values[p];
+          }
+
+        if( !(abs(_lu_values[_lu_diagonal[i]]) > 0) )
+          return false;
+      }
+
+    return true;
+  }
+
+  template<typename CoeffType>
+  template <typename VectorType>
+  inline
+  void SparseLU<CoeffType>::solve( VectorType& x )
+  {
+    antioch_assert_equal_to( x.size(), _n );
+
+    for(unsigned int i = 0; i < _n; i++)
+      _work[i] = x[_permutation[i]];
+
+    for(unsigned int i = 0; i < _n; i++)
+      for(unsigned int q = _lu_offsets[i]; q < _lu_diagonal[i]; q++)
+        _work[i] -= _lu_values[q] * _work[_lu_columns[q]];
+
+    for(unsigned int i = _n; i-- > 0;)
+      {
+        for(unsigned int q = _lu_diagonal[i] + 1; q < _lu_offsets[i+1]; q++)
+          _work[i] -= _lu_values[q] * _work[_lu_columns[q]];
+        _work[i] /= _lu_values[_lu_diagonal[i]];
+
+        x[_permutation[i]] = _work[i];
+      }
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_SPARSE_LU_H
@@ -0,0 +1,369 @@
+//-----------------------------------------------------------------------bl-
+//--------------------------------------------------------------------------
+//
+// Antioch - A Gas Dynamics Thermochemistry Library
+//
+// Copyright (C) 2014-2016 Paul T. Bauman, Benjamin S. Kirk,
+//                         Sylvain Plessis, Roy H. Stonger
+//
+// Copyright (C) 2013 The PECOS Development Team
+//
+// This library is free software; you can redistribute it and/or
+// modify it under the terms of the Version 2.1 GNU Lesser General
+// Public License as published by the Free Software Foundation.
+//
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this library; if not, write to the Free Software
+// Foundation, Inc. 51 Franklin Street, Fifth Floor,
+// Boston, MA  02110-1301  USA
+//
+//-----------------------------------------------------------------------el-
+
+#ifndef ANTIOCH_STOICHIOMETRIC_MATRIX_H
+#define ANTIOCH_STOICHIOMETRIC_MATRIX_H
+
+// Antioch
+#include "antioch/antioch_asserts.h"
+#include "antioch/metaprogramming.h"
+#include "antioch/reaction_set.h"
+
+// C++
+#include <vector>
+
+namespace Antioch
+{
+
+  //! Net stoichiometric matrix of a ReactionSet
+  /*!\class StoichiometricMatrix
+   *
+   * Stores \f$\nu_{s,r} = \nu^{\prime\prime}_{s,r} - \nu^\prime_{s,r}\f$,
+   * products minus reactants, as a sparse matrix of size
+   * n_species \f$\times\f$ n_reactions.  The matrix is stored
+   * both in compressed rows (CSR, one row per species) and in compressed
+   * columns (CSC, one column per reaction), so that both the product
+   * \f$\dot{\omega} = \nu \cdot \mathbf{R}\f$ (species sources from
+   * rates of progress) and the transposed product \f$\nu^T \cdot \mathbf{y}\f$
+   * (adjoints) are gathers without any write conflict.
+   *
+   * Zero net coefficients (a species appearing on both sides with the same
+   * coefficient) are not stored.
+   */
+  template<typename CoeffType=double>
+  class StoichiometricMatrix
+  {
+  public:
+
+    //! Constructor, builds the matrix from the reaction set.
+    StoichiometricMatrix( const ReactionSet<CoeffType>& reaction_set );
+
+    ~StoichiometricMatrix();
+
+    //! (Re)build the matrix from \p reaction_set.
+    void build( const ReactionSet<CoeffType>& reaction_set );
+
+    //! \returns the number of species (rows).
+    unsigned int n_species() const;
+
+    //! \returns the number of reactions (columns).
+    unsigned int n_reactions() const;
+
+    //! \returns the number of stored coefficients.
+    unsigned int n_nonzeros() const;
+
+    //! CSR: coefficients of species s are in [row_offsets()[s],row_offsets()[s+1])
+    const std::vector<unsigned int>& row_offsets() const;
+
+    //! CSR: reaction index of each coefficient
+    const std::vector<unsigned int>& row_reactions() const;
+
+    //! CSR: coefficients
+    const std::vector<CoeffType>& row_coefficients() const;
+
+    //! CSC: coefficients of reaction r are in [column_offsets()[r],column_offsets()[r+1])
+    const std::vector<unsigned int>& column_offsets() const;
+
+    //! CSC: species index of each coefficient
+    const std::vector<unsigned int>& column_species() const;
+
+    //! CSC: coefficients
+    const std::vector<CoeffType>& column_coefficients() const;
+
+    //! \f$\mathrm{species}_s = \sum_r \nu_{s,r} \mathrm{reactions}_r\f$
+    /*!
+     * \p species is overwritten.
+     */
+    template <typename VectorReactionsType, typename VectorSpeciesType>
+    void multiply( const VectorReactionsType& reactions,
+                   VectorSpeciesType& species ) const;
+
+    //! \f$\mathrm{species}_{s,t} = \sum_r \nu_{s,r} \mathrm{reactions}_{r,t}\f$
+    /*!
+     * Row by row product of a n_reactions \f$\times\f$ n_cols matrix,
+     * typically the species derivatives of the rates of progress.
+     * \p species is overwritten.
+     */
+    template <typename MatrixReactionsType, typename MatrixSpeciesType>
+    void multiply_matrix( const MatrixReactionsType& reactions,
+                          MatrixSpeciesType& species ) const;
+
+    //! \f$\mathrm{reactions}_r = \sum_s \nu_{s,r} \mathrm{species}_s\f$
+    /*!
+     * \p reactions is overwritten.
+     */
+    template <typename VectorSpeciesType, typename VectorReactionsType>
+    void transpose_multiply( const VectorSpeciesType& species,
+                             VectorReactionsType& reactions ) const;
+
+  protected:
+
+    unsigned int _n_species;
+
+    unsigned int _n_reactions;
+
+    std::vector<unsigned int> _row_offsets;
+    std::vector<unsigned int> _row_reactions;
+    std::vector<CoeffType>    _row_coefficients;
+
+    std::vector<unsigned int> _column_offsets;
+    std::vector<unsigned int> _column_species;
+    std::vector<CoeffType>    _column_coefficients;
+
+  private:
+
+    StoichiometricMatrix();
+
+  };
+
+  /* ------------------------- Inline Functions -------------------------*/
+  template<typename CoeffType>
+  inline
+  StoichiometricMatrix<CoeffType>::StoichiometricMatrix( const ReactionSet<CoeffType>& reaction_set )
+    : _n_species(0),
+      _n_reactions(0)
+  {
+    this->build(reaction_set);
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  StoichiometricMatrix<CoeffType>::~StoichiometricMatrix()
+  {
+    return;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int StoichiometricMatrix<CoeffType>::n_species() const
+  {
+    return _n_species;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int StoichiometricMatrix<CoeffType>::n_reactions() const
+  {
+    return _n_reactions;
+  }
+
+  template<typename CoeffType>
+  inline
+  unsigned int StoichiometricMatrix<CoeffType>::n_nonzeros() const
+  {
+    return _row_coefficients.size();
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& StoichiometricMatrix<CoeffType>::row_offsets() const
+  {
+    return _row_offsets;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& StoichiometricMatrix<CoeffType>::row_reactions() const
+  {
+    return _row_reactions;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<CoeffType>& StoichiometricMatrix<CoeffType>::row_coefficients() const
+  {
+    return _row_coefficients;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& StoichiometricMatrix<CoeffType>::column_offsets() const
+  {
+    return _column_offsets;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<unsigned int>& StoichiometricMatrix<CoeffType>::column_species() const
+  {
+    return _column_species;
+  }
+
+  template<typename CoeffType>
+  inline
+  const std::vector<CoeffType>& StoichiometricMatrix<CoeffType>::column_coefficients() const
+  {
+    return _column_coefficients;
+  }
+
+  template<typename CoeffType>
+  inline
+  void StoichiometricMatrix<CoeffType>::build( const ReactionSet<CoeffType>& reaction_set )
+  {
+    _n_species   = reaction_set.n_species();
+    _n_reactions = reaction_set.n_reactions();
+
+    // CSC first, reaction by reaction, merging the species
+    // appearing several times
+    _column_offsets.assign(1,0);
+    _column_species.clear();
+    _column_coefficients.clear();
+
+    std::vector<int> net(_n_species,0);
+    std::vector<unsigned int> touched;
+
+    for(unsigned int rxn = 0; rxn < _n_reactions; rxn++)
+      {
+        const Reaction<CoeffType>& reaction = reaction_set.reaction(rxn);
+
+        touched.clear();
+        for(unsigned int r = 0; r < reaction.n_reactants(); r++)
+          {
+            touched.push_back(reaction.reactant_id(r));
+            net[reaction.reactant_id(r)] -= static_cast<int>(reaction.reactant_stoichiometric_coefficient(r));
+          }
+        for(unsigned int p = 0; p < reaction.n_products(); p++)
+          {
+            touched.push_back(reaction.product_id(p));
+            net[reaction.product_id(p)] += static_cast<int>(reaction.product_stoichiometric_coefficient(p));
+          }
+
+        // keep the reactants then products order, each species once
+        for(unsigned int i = 0; i < touched.size(); i++)
+          {
+            const unsigned int s = touched[i];
+            if(net[s] != 0)
+              {
+                _column_species.push_back(s);
+                _column_coefficients.push_back(static_cast<CoeffType>(net[s]));
+                net[s] = 0;
+              }
+          }
+        _column_offsets.push_back(_column_species.size());
+      }
+
+    // CSR by transposition, reactions are in increasing order in each row
+    _row_offsets.assign(_n_species + 1,0);
+    for(unsigned int i = 0; i < _column_species.size(); i++)
+      {
+        _row_offsets[_column_species[i] + 1]++;
+      }
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        _row_offsets[s + 1] += _row_offsets[s];
+      }
+
+    _row_reactions.resize(_column_species.size());
+    _row_coefficients.resize(_column_species.size());
+    std::vector<unsigned int> position(_row_offsets.begin(),_row_offsets.end() - 1);
+    for(unsigned int rxn = 0; rxn < _n_reactions; rxn++)
+      {
+        for(unsigned int i = _column_offsets[rxn]; i < _column_offsets[rxn + 1]; i++)
+          {
+            const unsigned int pos = position[_column_species[i]]++;
+            _row_reactions[pos]    = rxn;
+            _row_coefficients[pos] = _column_coefficients[i];
+          }
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template <typename VectorReactionsType, typename VectorSpeciesType>
+  inline
+  void StoichiometricMatrix<CoeffType>::multiply( const VectorReactionsType& reactions,
+                                                  VectorSpeciesType& species ) const
+  {
+    antioch_assert_equal_to( reactions.size(), this->n_reactions() );
+    antioch_assert_equal_to( species.size(), this->n_species() );
+
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        Antioch::set_zero(species[s]);
+        for(unsigned int i = _row_offsets[s]; i < _row_offsets[s + 1]; i++)
+          {
+            species[s] += _row_coefficients[i] * reactions[_row_reactions[i]];
+          }
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template <typename MatrixReactionsType, typename MatrixSpeciesType>
+  inline
+  void StoichiometricMatrix<CoeffType>::multiply_matrix( const MatrixReactionsType& reactions,
+                                                         MatrixSpeciesType& species ) const
+  {
+    antioch_assert_equal_to( reactions.size(), this->n_reactions() );
+    antioch_assert_equal_to( species.size(), this->n_species() );
+
+    for(unsigned int s = 0; s < _n_species; s++)
+      {
+        Antioch::set_zero(species[s]);
+        for(unsigned int i = _row_offsets[s]; i < _row_offsets[s + 1]; i++)
+          {
+            const CoeffType nu = _row_coefficients[i];
+            const unsigned int rxn = _row_reactions[i];
+
+            antioch_assert_equal_to( reactions[rxn].size(), species[s].size() );
+
+            for(unsigned int t = 0; t < species[s].size(); t++)
+              {
+                species[s][t] += nu * reactions[rxn][t];
+              }
+          }
+      }
+
+    return;
+  }
+
+  template<typename CoeffType>
+  template <typename VectorSpeciesType, typename VectorReactionsType>
+  inline
+  void StoichiometricMatrix<CoeffType>::transpose_multiply( const VectorSpeciesType& species,
+                                                            VectorReactionsType& reactions ) const
+  {
+    antioch_assert_equal_to( species.size(), this->n_species() );
+    antioch_assert_equal_to( reactions.size(), this->n_reactions() );
+
+    for(unsigned int rxn = 0; rxn < _n_reactions; rxn++)
+      {
+        Antioch::set_zero(reactions[rxn]);
+        for(unsigned int i = _column_offsets[rxn]; i < _column_offsets[rxn + 1]; i++)
+          {
+            reactions[rxn] += _column_coefficients[i] * species[_column_species[i]];
+          }
+      }
+
+    return;
+  }
+
+} // end namespace Antioch
+
+#endif // ANTIOCH_STOICHIOMETRIC_MATRIX_H
@@ -98,8 +98,6 @@ namespace Antioch
                                                    const KineticsModel::KineticsModel kin)
     :Reaction<CoeffType>(n_species,equation,reversible,ReactionType::THREE_BODY,kin)
   {
-    Reaction<CoeffType>::_efficiencies.resize(n_species);
-    std::fill (Reaction<CoeffType>::_efficiencies.begin(), Reaction<CoeffType>::_efficiencies.end(), 1.);
     return;
   }
 
@@ -119,13 +117,15 @@ namespace Antioch
                                                                             const KineticsConditions<StateType,VectorStateType>& conditions  ) const
   {
     //k(T,[M]) = (sum eff_i * C_i) * ...
-    StateType kfwd = (this->efficiency(0) * molar_densities[0] );
+    StateType kfwd = molar_densities[0];
 
     for (unsigned int s=1; s<this->n_species(); s++)
       {
-        kfwd += ( this->efficiency(s) * molar_densities[s] );
+        kfwd += molar_densities[s];
       }
 
+    kfwd = this->efficiency_weighted_concentration(kfwd,molar_densities);
+
     //... alpha(T)
     kfwd *= (*this->_forward_rate[0])(conditions);
 
@@ -151,22 +151,25 @@ namespace Antioch
     this->_forward_rate[0]->compute_rate_and_derivative(conditions,kfwd,dkfwd_dT);
 
     dkfwd_dX[0] = kfwd;
-    StateType coef = (this->efficiency(0) * molar_densities[0]);
+    StateType coef = molar_densities[0];
 
     for (unsigned int s=1; s<this->n_species(); s++)
       {
-        coef += ( this->efficiency(s) * molar_densities[s] );
+        coef += molar_densities[s];
         dkfwd_dX[s] = kfwd;
       }
 
-    kfwd *= coef;
-    dkfwd_dT *= coef;
+    coef = this->efficiency_weighted_concentration(coef,molar_densities);
 
-    for (unsigned int s=0; s<this->n_species(); s++)
+    // only the overridden efficiencies differ from 1
+    for (unsigned int i=0; i<this->n_efficiency_overrides(); i++)
       {
-        dkfwd_dX[s] *= this->efficiency(s);
+        dkfwd_dX[this->efficiency_override_id(i)] *= this->efficiency_override(i);
       }
 
+    kfwd *= coef;
+    dkfwd_dT *= coef;
+
     antioch_assert(!has_nan(kfwd));
 
     return;
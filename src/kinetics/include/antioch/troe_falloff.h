@@ -143,6 +143,69 @@ namespace Antioch
                            StateType &dF_dT,
                            VectorStateType &dF_dX) const;
 
+    //! F and derivatives, concentration derivative with respect to [M]
+    /*!
+     * The dependence of \f$F\f$ on the concentrations goes only through
+     * \f$[\mathrm{M}]\f$, so this gives the scalar
+     * \f$\frac{\partial F}{\partial [\mathrm{M}]}\f$ instead of the
+     * n_species-long \f$\frac{\partial F}{\partial c_i}\f$.
+     */
+    template <typename StateType>
+    void F_and_derivatives(const StateType& T,
+                           const StateType &M,
+                           const StateType &k0,
+                           const StateType &dk0_dT,
+                           const StateType &kinf,
+                           const StateType &dkinf_dT,
+                           StateType &F,
+                           StateType &dF_dT,
+                           StateType &dF_dM) const;
+
+    //! \f$\frac{\partial \ln F}{\partial \ln P_r}\f$, with \f$P_r = [\mathrm{M}] k_0 / k_\infty\f$
+    template <typename StateType>
+    StateType dlogF_dlogPr(const StateType &T,
+                           const StateType &M,
+                           const StateType &k0,
+                           const StateType &kinf) const;
+
+    //! \f$F_{\text{cent}}\f$
+    template <typename StateType>
+    StateType Fcent(const StateType &T) const;
+
+    //! \f$F_{\text{cent}}\f$ and its temperature derivative
+    template <typename StateType>
+    void Fcent_and_derivatives( const StateType &T,
+                                StateType &Fc,
+                                StateType &dFc_dT ) const;
+
+    //! F from a precomputed \f$F_{\text{cent}}\f$ and \f$\ln(F_{\text{cent}})\f$
+    /*!
+     * \f$F_{\text{cent}}\f$ depends on the temperature only, so that it can
+     * be computed once per temperature for all the Troe reactions of a
+     * mechanism, see CompiledReactionSet.
+     */
+    template <typename StateType>
+    StateType F_from_Fcent(const StateType &M,
+                           const StateType &k0,
+                           const StateType &kinf,
+                           const StateType &Fcent,
+                           const StateType &logFcent) const;
+
+    //! F and derivatives from a precomputed \f$F_{\text{cent}}\f$, \f$\ln(F_{\text{cent}})\f$
+    //  and \f$\frac{\partial F_{\text{cent}}}{\partial T}\f$, concentration derivative with respect to [M]
+    template <typename StateType>
+    void F_and_derivatives_from_Fcent(const StateType &M,
+                                      const StateType &k0,
+                                      const StateType &dk0_dT,
+                                      const StateType &kinf,
+                                      const StateType &dkinf_dT,
+                                      const StateType &Fcent,
+                                      const StateType &logFcent,
+                                      const StateType &dFcent_dT,
+                                      StateType &F,
+                                      StateType &dF_dT,
+                                      StateType &dF_dM) const;
+
   private:
 
     unsigned int n_spec;
@@ -159,14 +222,6 @@ namespace Antioch
     /*! This is needed because Eigen doesn't understand log10. */
     CoeffType _n_coeff;
 
-    template <typename StateType>
-    StateType Fcent(const StateType &T) const;
-
-    template <typename StateType>
-    void Fcent_and_derivatives( const StateType &T,
-                                StateType &Fc,
-                                StateType &dFc_dT ) const;
-
   };
 
   template<typename CoeffType>
@@ -246,6 +301,18 @@ namespace Antioch
     // carefully to avoid returning NaN.
     StateType logFcent = ant_log(F_cent);  // = -huge
 
+    return this->F_from_Fcent(M,k0,kinf,F_cent,logFcent);
+  }
+
+  template<typename CoeffType>
+  template<typename StateType>
+  inline
+  StateType TroeFalloff<CoeffType>::F_from_Fcent(const StateType &M,
+                                                 const StateType &k0,
+                                                 const StateType &kinf,
+                                                 const StateType &Fcent,
+                                                 const StateType &logFcent) const
+  {
     // Pr = [M] * k0/kinf
     ANTIOCH_AUTO(StateType) Pr = M * k0/kinf;
     // c = -0.4 - 0.67 * log10(Fcent)
@@ -255,7 +322,7 @@ namespace Antioch
     // n = 0.75 - 1.27 * log10(Fcent)
     // Note log10(x) = (1.0/log(10))*log(x)
     ANTIOCH_AUTO(StateType) n = CoeffType(0.75L) - _n_coeff * logFcent;  // = _n_coeff*huge
-    ANTIOCH_AUTO(StateType) d = constant_clone(T,CoeffType(0.14L));
+    ANTIOCH_AUTO(StateType) d = constant_clone(M,CoeffType(0.14L));
 
     StateType log10Pr = Constants::log10_to_log<CoeffType>() * ant_log(Pr);
 
@@ -270,9 +337,9 @@ namespace Antioch
 
     StateType returnval = ant_exp(logF);
 
-    typename Antioch::rebind<StateType, bool>::type Fcent_is_nonzero = (F_cent != Antioch::zero_clone(T));
+    typename Antioch::rebind<StateType, bool>::type Fcent_is_nonzero = (Fcent != Antioch::zero_clone(M));
 
-    returnval = Antioch::if_else(Fcent_is_nonzero, returnval, Antioch::zero_clone(T));
+    returnval = Antioch::if_else(Fcent_is_nonzero, returnval, Antioch::zero_clone(M));
     // = exp(-huge) = 0
 
     antioch_assert(!has_nan(returnval));
@@ -281,6 +348,38 @@ namespace Antioch
   }
 
 
+  template<typename CoeffType>
+  template<typename StateType>
+  inline
+  StateType TroeFalloff<CoeffType>::dlogF_dlogPr(const StateType &T,
+                                                 const StateType &M,
+                                                 const StateType &k0,
+                                                 const StateType &kinf) const
+  {
+    StateType F_cent = this->Fcent(T);
+    StateType logFcent = ant_log(F_cent);
+
+    StateType  c = - CoeffType(0.4L) - _c_coeff * logFcent;
+    StateType  n = CoeffType(0.75L) - _n_coeff * logFcent;
+    StateType  d = constant_clone(M,CoeffType(0.14L));
+
+    StateType log10Pr = Constants::log10_to_log<CoeffType>() * ant_log(M * k0/kinf);
+
+    // logF = logFcent/(1 + q^2), q = (log10Pr + c)/(n - d*(log10Pr + c)),
+    // dq_dlog10Pr = n/(n - d*(log10Pr + c))^2
+    StateType denom = n - d * (log10Pr + c);
+    StateType q = (log10Pr + c)/denom;
+
+    StateType returnval = - 2 * Constants::log10_to_log<CoeffType>() * logFcent * q * n
+                          / (ant_pow(denom,2) * ant_pow(1 + q * q,2));
+
+    // F = 0, see F_from_Fcent()
+    typename Antioch::rebind<StateType, bool>::type Fcent_is_nonzero = (F_cent != Antioch::zero_clone(M));
+    returnval = Antioch::if_else(Fcent_is_nonzero, returnval, Antioch::zero_clone(M));
+
+    return returnval;
+  }
+
   template <typename CoeffType>
   template <typename StateType>
   inline
@@ -331,28 +430,74 @@ namespace Antioch
 
     antioch_assert_equal_to(dF_dX.size(),this->n_spec);
 
-    //declarations
-    // Pr and derivatives
-    StateType Pr = M * k0/kinf;
-    StateType dPr_dT = Pr * (dk0_dT/k0 - dkinf_dT/kinf);
-    StateType log10Pr = Constants::log10_to_log<CoeffType>() * ant_log(Pr);
-    StateType dlog10Pr_dT = Constants::log10_to_log<CoeffType>()*dPr_dT/Pr;
-    VectorStateType dlog10Pr_dX = Antioch::zero_clone(dF_dX);
-    for(unsigned int ip = 0; ip < dlog10Pr_dX.size(); ip++)
-      {//dlog10Pr_dX = 1/(ln(10)*Pr) * dPr_dX
-        dlog10Pr_dX[ip] = Constants::log10_to_log<CoeffType>()/M; //dPr_dX = k0/kinf, Pr = M k0/kinf => dlog10Pr_dX = 1/(ln(10)*M)
+    // F depends on the concentrations only through [M]
+    StateType dF_dM = Antioch::zero_clone(T);
+    this->F_and_derivatives(T,M,k0,dk0_dT,kinf,dkinf_dT,F,dF_dT,dF_dM);
+
+    for(unsigned int ip = 0; ip < dF_dX.size(); ip++)
+      {
+        dF_dX[ip] = dF_dM;
       }
+
+    return;
+  }
+
+
+  template <typename CoeffType>
+  template <typename StateType>
+  inline
+  void TroeFalloff<CoeffType>::F_and_derivatives(const StateType& T,
+                                                 const StateType &M,
+                                                 const StateType &k0,
+                                                 const StateType &dk0_dT,
+                                                 const StateType &kinf,
+                                                 const StateType &dkinf_dT,
+                                                 StateType &F,
+                                                 StateType &dF_dT,
+                                                 StateType &dF_dM) const
+  {
     // Fcent and derivatives
     StateType Fcent = Antioch::zero_clone(T);
     StateType dFcent_dT = Antioch::zero_clone(T);
     this->Fcent_and_derivatives(T,Fcent,dFcent_dT);
+
     antioch_assert(!has_nan(Fcent));
 
-    StateType dlog10Fcent_dT = Constants::log10_to_log<CoeffType>()*dFcent_dT/Fcent;
     // Compute log(Fcent) once
     StateType logFcent = ant_log(Fcent);
+
+    this->F_and_derivatives_from_Fcent(M,k0,dk0_dT,kinf,dkinf_dT,Fcent,logFcent,dFcent_dT,F,dF_dT,dF_dM);
+
+    return;
+  }
+
+  template <typename CoeffType>
+  template <typename StateType>
+  inline
+  void TroeFalloff<CoeffType>::F_and_derivatives_from_Fcent(const StateType &M,
+                                                            const StateType &k0,
+                                                            const StateType &dk0_dT,
+                                                            const StateType &kinf,
+                                                            const StateType &dkinf_dT,
+                                                            const StateType &Fcent,
+                                                            const StateType &logFcent,
+                                                            const StateType &dFcent_dT,
+                                                            StateType &F,
+                                                            StateType &dF_dT,
+                                                            StateType &dF_dM) const
+  {
+    // Pr and derivatives
+    StateType Pr = M * k0/kinf;
+    StateType dPr_dT = Pr * (dk0_dT/k0 - dkinf_dT/kinf);
+    StateType log10Pr = Constants::log10_to_log<CoeffType>() * ant_log(Pr);
+    StateType dlog10Pr_dT = Constants::log10_to_log<CoeffType>()*dPr_dT/Pr;
+    //dlog10Pr_dM = 1/(ln(10)*M)
+    StateType dlog10Pr_dM = Constants::log10_to_log<CoeffType>()/M;
+
+    StateType dlog10Fcent_dT = Constants::log10_to_log<CoeffType>()*dFcent_dT/Fcent;
+
     // n and c and derivatives
-    StateType  d = Antioch::constant_clone(T, CoeffType(0.14L));
+    StateType  d = Antioch::constant_clone(M, CoeffType(0.14L));
     StateType  c = - CoeffType(0.4L) - _c_coeff * logFcent;
     StateType  n = CoeffType(0.75L) - _n_coeff * logFcent;
     StateType dc_dT = - _c_coeff * dFcent_dT/Fcent;
@@ -360,34 +505,29 @@ namespace Antioch
 
     //log10F
     StateType logF = logFcent/(1 + ant_pow(((log10Pr + c)/(n - d*(log10Pr + c) )),2));
-    StateType dlogF_dT = logF * (dlog10Fcent_dT / Fcent 
+    StateType dlogF_dT = logF * (dlog10Fcent_dT / Fcent
                                      - 2 * ant_pow((log10Pr + c)/(n - d * (log10Pr + c)),2)
                                        * ((dlog10Pr_dT + dc_dT)/(log10Pr + c) -
                                           (dn_dT - d * (dlog10Pr_dT + dc_dT))/(n - d * (log10Pr + c))
                                          )
                                        / (1 + ant_pow((log10Pr + c)/(n - d * (log10Pr + c)),2))
                                     );
-    VectorStateType dlogF_dX = Antioch::zero_clone(dF_dX);
-    for(unsigned int ip = 0; ip < dlog10Pr_dX.size(); ip++)
-      {//dlogF_dX = - logF^2/log(Fcent) * dlog10Pr_dX * (1 - 1/(n - d * (log10Pr + c))) * (log10Pr + c)
-        dlogF_dX[ip] = - ant_pow(logF,2)/logFcent * dlog10Pr_dX[ip] *(1 - 1/(n - d * (log10Pr + c))) * (log10Pr + c);
-      }
+
+    //dlogF_dM = - logF^2/log(Fcent) * dlog10Pr_dM * (1 - 1/(n - d * (log10Pr + c))) * (log10Pr + c)
+    StateType dlogF_dM = - ant_pow(logF,2)/logFcent * dlog10Pr_dM *(1 - 1/(n - d * (log10Pr + c))) * (log10Pr + c);
 
     F = ant_exp(logF);
-    typename Antioch::rebind<StateType, bool>::type Fcent_is_nonzero = (Fcent != Antioch::zero_clone(T));
-    F = Antioch::if_else(Fcent_is_nonzero, F, Antioch::zero_clone(T));
+    typename Antioch::rebind<StateType, bool>::type Fcent_is_nonzero = (Fcent != Antioch::zero_clone(M));
+    F = Antioch::if_else(Fcent_is_nonzero, F, Antioch::zero_clone(M));
+
     antioch_assert(!has_nan(F));
 
     dF_dT = F * dlogF_dT;
-    for(unsigned int ip = 0; ip < dlog10Pr_dX.size(); ip++)
-      {//dF_dX =  F * dlogF_dX
-        dF_dX[ip] = F * dlogF_dX[ip];
-      }
+    dF_dM = F * dlogF_dM;
 
     return;
   }
 
-
   template<typename CoeffType>
   inline
   TroeFalloff<CoeffType>::TroeFalloff(const unsigned int nspec, const CoeffType alpha,
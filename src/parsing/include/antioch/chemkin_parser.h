@@ -147,6 +147,9 @@ namespace Antioch{
          /*! return reversible state*/
          bool reaction_reversible() const;
 
+         /*! return true if the reaction holds the REV parameters of the previous one*/
+         bool reaction_explicit_reverse() const;
+
          /*! return pairs of reactants and stoichiometric coefficients*/
          bool reactants_pairs(std::vector<std::pair<std::string,int> > & reactants_pair) const;
 
@@ -299,6 +302,7 @@ namespace Antioch{
           std::string _cached_line;
           bool        _duplicate_process;
           bool        _next_is_reverse;
+          bool        _explicit_reverse;
 
           const ChemKinDefinitions _spec;
 
@@ -339,6 +343,13 @@ namespace Antioch{
      return _reversible;
   }
 
+  template <typename NumericType>
+  inline
+  bool ChemKinParser<NumericType>::reaction_explicit_reverse() const
+  {
+     return _explicit_reverse;
+  }
+
   template <typename NumericType>
   inline
   const std::string ChemKinParser<NumericType>::reaction_kinetics_model(const std::vector<std::string> & /*kinetics_models*/) const
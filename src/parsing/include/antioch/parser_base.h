@@ -192,6 +192,10 @@ namespace Antioch
     virtual bool reaction_reversible() const
     {antioch_not_implemented_msg(_not_implemented); return false;}
 
+    /*! \return true if the reaction holds the explicit reverse rate constant of the previous one*/
+    virtual bool reaction_explicit_reverse() const
+    {return false;}
+
     /*! \return pairs of reactants and stoichiometric coefficients*/
     virtual bool reactants_pairs(std::vector<std::pair<std::string,int> > & /*reactants_pair*/) const
     {antioch_not_implemented_msg(_not_implemented); return false;}